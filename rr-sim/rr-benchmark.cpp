@@ -0,0 +1,238 @@
+// Measures the simulator over synthetic traces of growing size. For every trace
+// size it writes a text trace, times readfile() on it (parse throughput), then
+// times every (engine, time quantum, overhead) combination on the parsed workload.
+// Results are written one record per measurement, as CSV or JSON lines, so runs
+// can be compared with each other.
+//
+//     rr-benchmark [--sizes=1000,10000,...] [--tqs=0.05,0.5] [--overheads=0,0.01]
+//                  [--engines=reference,step,engine] [--workload=SPEC]
+//                  [--format=csv|jsonl] [--output=FILE] [--dir=TMPDIR]
+//
+// Engines: "reference" is run_simulator() with fast forwarding, "step" is
+// run_simulator() executing every quantum and "engine" is the compile-time
+// specialized Engine_Module. The traces come from Generator_Module (SPEC is a
+// Generator_Config description; "jobs" is taken from --sizes).
+
+#include <chrono>
+#include <sstream>
+#include <cstdio>
+#include <sys/stat.h>
+
+#include "rr-simulator.h"
+
+// One measurement
+struct Bench_Record {
+    string kind;                // "parse" or "run"
+    string engine;              // the engine (runs only)
+    unsigned long long jobs;    // trace size
+    float timeQuantum;          // (runs only)
+    float overhead;             // (runs only)
+    double seconds;             // wall clock time of the measurement
+    unsigned long long events;  // arrivals + time slices (runs only)
+    unsigned long long quanta;  // time slices run (runs only)
+    unsigned long long bytes;   // size of the trace file (parse only)
+    long rssKb;                 // peak resident set size during the measurement
+};
+
+bool parse_list(const string&, vector<double>&);
+bool reset_peak_rss();
+long peak_rss_kb(bool);
+void write_record(ostream&, const Bench_Record&, bool);
+
+int main(int argc, char** argv) {
+    vector<double> sizes, tqs, overheads;
+    parse_list("1000,10000,100000,1000000", sizes);
+    parse_list("0.05,0.1,0.5", tqs);
+    parse_list("0,0.01", overheads);
+    vector<string> engines;
+    engines.push_back("reference");
+    engines.push_back("step");
+    engines.push_back("engine");
+    Generator_Config synthetic;
+    bool jsonl = false;
+    string outfile, dir = "/tmp";
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool ok = true;
+        if (arg.compare(0, 8, "--sizes=") == 0) {
+            ok = parse_list(arg.substr(8), sizes);
+        } else if (arg.compare(0, 6, "--tqs=") == 0) {
+            ok = parse_list(arg.substr(6), tqs);
+        } else if (arg.compare(0, 12, "--overheads=") == 0) {
+            ok = parse_list(arg.substr(12), overheads);
+        } else if (arg.compare(0, 10, "--engines=") == 0) {
+            engines.clear();
+            stringstream list(arg.substr(10));
+            string engine;
+            while (getline(list, engine, ','))
+                engines.push_back(engine);
+        } else if (arg.compare(0, 11, "--workload=") == 0) {
+            ok = synthetic.Parse(arg.substr(11));
+        } else if (arg == "--format=csv") {
+            jsonl = false;
+        } else if (arg == "--format=jsonl") {
+            jsonl = true;
+        } else if (arg.compare(0, 9, "--output=") == 0) {
+            outfile = arg.substr(9);
+        } else if (arg.compare(0, 6, "--dir=") == 0) {
+            dir = arg.substr(6);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            cerr << "Unknown or malformed argument " << arg << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+    for (size_t e = 0; e < engines.size(); e++) {
+        if (engines[e] != "reference" && engines[e] != "step" && engines[e] != "engine") {
+            cerr << "Unknown engine " << engines[e] << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+    ofstream file;
+    if (!outfile.empty()) {
+        file.open(outfile.c_str());
+        if (!file.good()) {
+            cerr << "Could not open " << outfile << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+    ostream& out = outfile.empty() ? cout : file;
+    if (!jsonl)
+        out << "kind,engine,jobs,tq,overhead,seconds,events,quanta,events_per_sec,"
+               "ns_per_quantum,bytes,mb_per_sec,rss_kb\n";
+
+    Simulation_Module* run = new Simulation_Module;
+    for (size_t s = 0; s < sizes.size(); s++) {
+        unsigned long long jobs = (unsigned long long)sizes[s];
+        // ==== parse throughput ==== //
+        string trace = dir + "/rr-benchmark-" + to_string(jobs) + ".txt";
+        {
+            Workload_Module generated;
+            synthetic.jobs = jobs;
+            Generator_Module generator(synthetic);
+            generator.Fill(generated);
+            if (!generated.SaveText(trace.c_str())) {
+                cerr << "Could not write " << trace << "\n";
+                return EXIT_FAILURE;
+            }
+        }
+        struct stat st;
+        stat(trace.c_str(), &st);
+        Workload_Module workload;
+        bool peakReset = reset_peak_rss();
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        if (readfile(workload, trace.c_str()) != SS_OK) {
+            cerr << "Could not read " << trace << "\n";
+            return EXIT_FAILURE;
+        }
+        chrono::duration<double> parsed = chrono::steady_clock::now() - start;
+        remove(trace.c_str());
+        Bench_Record parse = { "parse", "", jobs, 0.0f, 0.0f, parsed.count(), 0, 0,
+                                (unsigned long long)st.st_size, peak_rss_kb(peakReset) };
+        write_record(out, parse, jsonl);
+        // ==== simulation throughput ==== //
+        for (size_t e = 0; e < engines.size(); e++) {
+            for (size_t t = 0; t < tqs.size(); t++) {
+                for (size_t o = 0; o < overheads.size(); o++) {
+                    float tq = (float)tqs[t], ov = (float)overheads[o];
+                    Run_Metrics metrics;
+                    peakReset = reset_peak_rss();
+                    start = chrono::steady_clock::now();
+                    if (engines[e] == "engine") {
+                        WorkloadSource_Module source(&workload);
+                        run->Stats().Reset();
+                        metrics = run_engine(source, tq, ov, run->Stats());
+                    } else {
+                        run->Reset(tq, ov);
+                        run->Load(workload);
+                        run_simulator(run->Scheduler(), run->Cpu(),
+                                        run->Events(), engines[e] == "reference");
+                        metrics = run->Metrics();
+                    }
+                    chrono::duration<double> took = chrono::steady_clock::now() - start;
+                    Bench_Record record = { "run", engines[e], jobs, tq, ov, took.count(),
+                                            workload.Size() + metrics.dispatches,
+                                            metrics.dispatches, 0,
+                                            peak_rss_kb(peakReset) };
+                    write_record(out, record, jsonl);
+                }
+            }
+        }
+    }
+    delete run;
+    return EXIT_SUCCESS;
+}
+
+// PARSE LIST
+// Parses a comma separated list of numbers (false if it is malformed)
+bool parse_list(const string& text, vector<double>& values) {
+    values.clear();
+    stringstream list(text);
+    string item;
+    while (getline(list, item, ',')) {
+        char* end = NULL;
+        double value = strtod(item.c_str(), &end);
+        if (item.empty() || *end != '\0' || value < 0.0)
+            return false;
+        values.push_back(value);
+    }
+    return !values.empty();
+}
+
+// RESET PEAK RSS
+// Sets the process's peak resident set size back to its current one, so the next
+// peak covers a single measurement (false if the kernel does not support it)
+bool reset_peak_rss() {
+    FILE* clearRefs = fopen("/proc/self/clear_refs", "w");
+    if (clearRefs == NULL)
+        return false;
+    bool ok = (fputs("5", clearRefs) >= 0);
+    return (fclose(clearRefs) == 0 && ok);
+}
+
+// PEAK RSS KB
+// Returns the peak resident set size since the last reset_peak_rss() [KB] (-1 if
+// it cannot be read or the reset failed: the peak would then cover every
+// measurement before this one)
+long peak_rss_kb(bool reset) {
+    if (!reset)
+        return -1;
+    FILE* status = fopen("/proc/self/status", "r");
+    if (status == NULL)
+        return -1;
+    char line[256];
+    long peak = -1;
+    while (fgets(line, sizeof(line), status) != NULL) {
+        if (sscanf(line, "VmHWM: %ld kB", &peak) == 1)
+            break;
+    }
+    fclose(status);
+    return peak;
+}
+
+// WRITE RECORD
+// Writes one measurement as a CSV row or a JSON line
+void write_record(ostream& out, const Bench_Record& record, bool jsonl) {
+    double eventsPerSec = (record.seconds > 0.0) ? record.events / record.seconds : 0.0;
+    double nsPerQuantum = (record.quanta > 0) ? record.seconds * 1e9 / record.quanta : 0.0;
+    double mbPerSec = (record.seconds > 0.0) ? record.bytes / 1e6 / record.seconds : 0.0;
+    if (jsonl) {
+        out << "{\"kind\":\"" << record.kind << "\",\"engine\":\"" << record.engine
+            << "\",\"jobs\":" << record.jobs << ",\"tq\":" << record.timeQuantum
+            << ",\"overhead\":" << record.overhead << ",\"seconds\":" << record.seconds
+            << ",\"events\":" << record.events << ",\"quanta\":" << record.quanta
+            << ",\"events_per_sec\":" << eventsPerSec
+            << ",\"ns_per_quantum\":" << nsPerQuantum << ",\"bytes\":" << record.bytes
+            << ",\"mb_per_sec\":" << mbPerSec
+            << ",\"rss_kb\":" << record.rssKb << "}\n";
+    } else {
+        out << record.kind << "," << record.engine << "," << record.jobs << ","
+            << record.timeQuantum << "," << record.overhead << "," << record.seconds
+            << "," << record.events << "," << record.quanta << "," << eventsPerSec
+            << "," << nsPerQuantum << "," << record.bytes << "," << mbPerSec << ","
+            << record.rssKb << "\n";
+    }
+    out.flush();
+}
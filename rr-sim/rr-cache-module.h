@@ -0,0 +1,277 @@
+#ifndef RR_CACHE_MODULE_H_
+#define RR_CACHE_MODULE_H_
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+using namespace std;
+
+#include "rr-workload-module.h"
+#include "rr-results-module.h"
+
+// Cache file format (all fields in host byte order):
+//   header  | char magic[8] = "RRCACHE" | uint32 version | uint32 columns |
+//           | uint64 entries                                              |
+//   entries | Cache_Entry[entries] (sorted by key)                        |
+// The entries are fixed size and sorted, so a mapped file is searched in place.
+const char RR_CACHE_MAGIC[8] = { 'R', 'R', 'C', 'A', 'C', 'H', 'E', '\0' };
+const uint32_t RR_CACHE_VERSION = 1;
+
+// The version of the simulators' results: bump it whenever a change makes a
+// simulation come out differently, so the entries of older builds stop matching
+const uint32_t RR_SIM_ENGINE_VERSION = 2;
+
+struct Cache_Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t columns;       // Result_Row::NUMB_OF_COLUMNS
+    uint64_t entries;
+};
+
+// What a simulation's results depend on (floats are kept as their bit patterns)
+struct Cache_Key {
+    uint64_t trace;         // hash of the workload's arrival and service times
+    uint32_t engine;        // RR_SIM_ENGINE_VERSION
+    uint32_t cpus;          // simulated CPUs (0: the single CPU simulators)
+    uint32_t window;        // multi-CPU balance window [secs] (0: the default)
+    uint32_t timeQuantum;   // [secs]
+    uint32_t overhead;      // [secs]
+    uint32_t reserved;      // 0
+};
+
+// One cached simulation
+struct Cache_Entry {
+    Cache_Key key;
+    double values[Result_Row::NUMB_OF_COLUMNS];     // its results row
+};
+
+// Persistent results of past simulations, addressed by what they depend on: the
+// contents of the workload, the simulator version, the (time quantum, overhead)
+// cell and, for multi-CPU runs, the CPUs and balance window. The file is mapped
+// when the cache is opened and searched in place. New entries are queued and merged
+// in all at once (one per sweep) under a lock (FILE.lock), into a copy that
+// replaces the file with a rename, so readers (this or other sweeps) always map a
+// complete file.
+class Cache_Module {
+private:
+    string file;                    // the cache file
+    void* data;                     // the mapped file (NULL if there is none)
+    size_t size;                    // bytes mapped
+    const Cache_Entry* entries;     // the entries of the mapped file
+    uint64_t count;                 // entries in the mapped file
+    vector<Cache_Entry> pending;    // new entries waiting for Store
+
+    // the mapping is owned, so a cache is never copied
+    Cache_Module(const Cache_Module&) = delete;
+    Cache_Module& operator=(const Cache_Module&) = delete;
+
+public:
+    // CONSTRUCTOR - CACHE MODULE
+    // Opens the cache in "fileStr" (a missing or unreadable file is an empty cache)
+    Cache_Module(const string& fileStr) : file(fileStr) {
+        Map(file, data, size, entries, count);
+    }
+
+    // DE-CONSTRUCTOR - CACHE MODULE
+    ~Cache_Module() {
+        if (data != NULL)
+            munmap(data, size);
+    }
+
+    // SIZE
+    // Returns the number of simulations the cache held when it was opened
+    uint64_t Size() const {
+        return count;
+    }
+
+    // KEY FOR
+    // Returns the key of the simulation of a workload (hashed to "trace" by
+    // Workload_Module::Hash) with a time quantum and overhead, on "cpus" CPUs
+    // balanced every "window" seconds
+    static Cache_Key KeyFor(uint64_t trace, float timeQuantum, float overhead,
+                            unsigned int cpus = 0, float window = 0.0f) {
+        Cache_Key key;
+        memset(&key, 0, sizeof(key));
+        key.trace = trace;
+        key.engine = RR_SIM_ENGINE_VERSION;
+        key.cpus = cpus;
+        memcpy(&key.window, &window, sizeof(key.window));
+        memcpy(&key.timeQuantum, &timeQuantum, sizeof(key.timeQuantum));
+        memcpy(&key.overhead, &overhead, sizeof(key.overhead));
+        return key;
+    }
+
+    // FIND
+    // Looks "key" up and returns its results in "row" (false if it is not cached)
+    bool Find(const Cache_Key& key, Result_Row& row) const {
+        const Cache_Entry* end = entries + count;
+        const Cache_Entry* entry = lower_bound(entries, end, key, EntryBefore);
+        if (entry == end || Before(key, entry->key))
+            return false;
+        memcpy(row.values, entry->values, sizeof(row.values));
+        return true;
+    }
+
+    // ADD
+    // Queues the results of "key" for the next Store (the cache file is not touched)
+    void Add(const Cache_Key& key, const Result_Row& row) {
+        Cache_Entry entry;
+        entry.key = key;
+        memcpy(entry.values, row.values, sizeof(entry.values));
+        pending.push_back(entry);
+    }
+
+    // STORE
+    // Merges every queued entry into the cache file in one go, replacing entries
+    // with the same key (the last one queued wins). Returns false if the file could
+    // not be updated; other sweeps may store into the same file at the same time.
+    bool Store() {
+        if (pending.empty())
+            return true;
+        stable_sort(pending.begin(), pending.end(), EntryOrder);
+        string lockFile = file + ".lock";
+        int lock = open(lockFile.c_str(), O_RDWR | O_CREAT, 0644);
+        if (lock < 0)
+            return false;
+        flock(lock, LOCK_EX);
+        // merge into what the file holds now (others may have stored since)
+        vector<Cache_Entry> merged;
+        void* current;
+        size_t currentSize;
+        const Cache_Entry* currentEntries;
+        uint64_t currentCount;
+        Map(file, current, currentSize, currentEntries, currentCount);
+        merged.reserve(currentCount + pending.size());
+        const Cache_Entry* old = currentEntries;
+        const Cache_Entry* oldEnd = currentEntries + currentCount;
+        for (size_t i = 0; i < pending.size(); i++) {
+            const Cache_Key& key = pending[i].key;
+            for (; old != oldEnd && Before(old->key, key); old++)
+                merged.push_back(*old);
+            if (old != oldEnd && !Before(key, old->key))
+                old++;
+            if (i + 1 == pending.size() || Before(key, pending[i + 1].key))
+                merged.push_back(pending[i]);
+        }
+        merged.insert(merged.end(), old, oldEnd);
+        if (current != NULL)
+            munmap(current, currentSize);
+        bool ok = Write(merged);
+        close(lock);
+        pending.clear();
+        return ok;
+    }
+
+private:
+    // BEFORE
+    // Orders keys field by field
+    static bool Before(const Cache_Key& a, const Cache_Key& b) {
+        if (a.trace != b.trace)
+            return a.trace < b.trace;
+        const uint32_t x[] = { a.engine, a.cpus, a.window, a.timeQuantum, a.overhead,
+                                a.reserved };
+        const uint32_t y[] = { b.engine, b.cpus, b.window, b.timeQuantum, b.overhead,
+                                b.reserved };
+        for (int i = 0; i < 6; i++) {
+            if (x[i] != y[i])
+                return x[i] < y[i];
+        }
+        return false;
+    }
+
+    // ENTRY ORDER
+    // Orders entries by key (for sorting the queued entries)
+    static bool EntryOrder(const Cache_Entry& a, const Cache_Entry& b) {
+        return Before(a.key, b.key);
+    }
+
+    // ENTRY BEFORE
+    // Orders an entry before a key (for searching the sorted entries)
+    static bool EntryBefore(const Cache_Entry& a, const Cache_Key& b) {
+        return Before(a.key, b);
+    }
+
+    // MAP
+    // Maps cache file "fileStr" and finds its entries (false, with no entries, if
+    // there is no valid cache file)
+    static bool Map(const string& fileStr, void*& data, size_t& size,
+                    const Cache_Entry*& entries, uint64_t& count) {
+        data = NULL;
+        size = 0;
+        entries = NULL;
+        count = 0;
+        int fd = open(fileStr.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Cache_Header)) {
+            close(fd);
+            return false;
+        }
+        void* mapped = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED)
+            return false;
+        const Cache_Header* header = (const Cache_Header*)mapped;
+        uint64_t room = ((size_t)st.st_size - sizeof(Cache_Header)) / sizeof(Cache_Entry);
+        if (memcmp(header->magic, RR_CACHE_MAGIC, sizeof(RR_CACHE_MAGIC)) != 0 ||
+                header->version != RR_CACHE_VERSION ||
+                header->columns != Result_Row::NUMB_OF_COLUMNS ||
+                header->entries > room) {
+            munmap(mapped, (size_t)st.st_size);
+            return false;
+        }
+        data = mapped;
+        size = (size_t)st.st_size;
+        entries = (const Cache_Entry*)((const char*)mapped + sizeof(Cache_Header));
+        count = header->entries;
+        return true;
+    }
+
+    // WRITE
+    // Writes "merged" to a new file that then replaces the cache file (the caller
+    // holds the lock)
+    bool Write(const vector<Cache_Entry>& merged) const {
+        string tmpFile = file + ".tmp";
+        int fd = open(tmpFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            return false;
+        Cache_Header header;
+        memcpy(header.magic, RR_CACHE_MAGIC, sizeof(RR_CACHE_MAGIC));
+        header.version = RR_CACHE_VERSION;
+        header.columns = Result_Row::NUMB_OF_COLUMNS;
+        header.entries = merged.size();
+        bool ok = WriteAll(fd, &header, sizeof(header)) &&
+                    WriteAll(fd, merged.data(), merged.size() * sizeof(Cache_Entry)) &&
+                    fsync(fd) == 0;
+        ok = (close(fd) == 0) && ok;
+        if (ok)
+            ok = (rename(tmpFile.c_str(), file.c_str()) == 0);
+        if (!ok)
+            unlink(tmpFile.c_str());
+        return ok;
+    }
+
+    // WRITE ALL
+    // Writes "length" bytes to "fd" (false on error)
+    static bool WriteAll(int fd, const void* buffer, size_t length) {
+        const char* p = (const char*)buffer;
+        while (length > 0) {
+            ssize_t written = write(fd, p, length);
+            if (written <= 0)
+                return false;
+            p += written;
+            length -= (size_t)written;
+        }
+        return true;
+    }
+};
+
+#endif // RR_CACHE_MODULE_H_
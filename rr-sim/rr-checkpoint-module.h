@@ -0,0 +1,410 @@
+#ifndef RR_CHECKPOINT_MODULE_H_
+#define RR_CHECKPOINT_MODULE_H_
+
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+using namespace std;
+
+#include "rr-simulation-module.h"
+
+// Snapshot file format (all fields in host byte order, every section 8-byte
+// aligned; a snapshot only resumes on a host like the one that took it):
+//   header     | Snapshot_Header (the CPU, scheduler, queue, job table, arrivals |
+//              | and statistics scalars)                                         |
+//   histograms | uint64 count[buckets] x 3 (turn around, wait, slowdown)         |
+//   pcbs       | Snapshot_PCB[pcbs] (every job table slot handed out, by slot)   |
+//   ready      | uint32 slot[readyLength] (the ready queue, head first)          |
+//   released   | uint32 slot[released] (the job table's free list, in order)     |
+// A snapshot is taken between two events of run_simulator(), where the pending
+// event is always the one schedule_next_event() derives from the CPU and the
+// scheduler, so the event itself is not stored.
+const char RR_SNAPSHOT_MAGIC[8] = { 'R', 'R', 'S', 'N', 'A', 'P', 'S', 'H' };
+const uint32_t RR_SNAPSHOT_VERSION = 2;
+const uint32_t RR_SNAPSHOT_NO_SLOT = 0xFFFFFFFFu;
+
+// A histogram's scalars (its counts are in the histograms section)
+struct Snapshot_Histogram {
+    double unit;
+    uint64_t total;
+    double minValue;
+    double maxValue;
+};
+
+struct Snapshot_Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t pcbSize;               // sizeof(Snapshot_PCB)
+    // ==== cpu ==== //
+    double cpuTime;
+    float timeQuantum;
+    uint32_t currentSlot;           // the running process (RR_SNAPSHOT_NO_SLOT if idle)
+    // ==== scheduler ==== //
+    float overhead;
+    float schedulerStart;
+    float schedulerEnd;
+    uint32_t schedulerState;
+    uint32_t completed;
+    uint32_t padding;
+    int64_t readyLengthSum;
+    int64_t timesChecked;
+    // ==== ready queue ==== //
+    uint32_t readyLength;
+    uint32_t readyMaxLength;
+    // ==== job table ==== //
+    uint64_t pcbs;
+    uint64_t released;
+    // ==== arrivals ==== //
+    uint64_t position;              // index of the next process of the workload
+    uint64_t workloadSize;          // processes in the workload
+    uint64_t workloadHash;          // Workload_Module::Hash of the workload
+    uint32_t buckets;               // counts per histogram
+    uint32_t reserved;
+    // ==== statistics ==== //
+    uint64_t statsCompleted;
+    uint64_t turnTimeSum[2];        // the exact sums (low, high 64 bits)
+    uint64_t waitTimeSum[2];
+    Snapshot_Histogram histograms[3];
+};
+
+static_assert(sizeof(Snapshot_Header) % 8 == 0, "sections must stay 8-byte aligned");
+
+// A job as stored in a snapshot
+struct Snapshot_PCB {
+    uint32_t processId;
+    float arrivalTime;
+    float serviceTime;
+    float timeLeft;
+    double startTime;
+    uint32_t state;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(Snapshot_PCB) == 32, "jobs are stored without padding");
+
+// Saves the full state of an in-flight reference simulation (a Simulation_Module
+// replaying a loaded workload) to a snapshot file and restores it, so a run can be
+// resumed after a crash, or many runs can branch off one warmed-up state. Restore
+// maps the file and copies its sections straight into the run, so it costs about
+// as much as reading the file. A Checkpoint_Module object also saves its run
+// periodically while run_simulator() works on it (see Tick). A snapshot is tied to
+// its workload by Workload_Module::Hash(), which reads the whole workload, so the
+// caller computes it once and passes it in.
+class Checkpoint_Module {
+private:
+    static const unsigned int EVENTS_PER_CHECK = 65536;   // events between clock checks
+
+    Simulation_Module* run;                 // the run being checkpointed
+    uint64_t workloadHash;                  // the Hash() of the workload it replays
+    string fileName;                        // where its snapshots go
+    chrono::steady_clock::duration interval;    // wall clock time between snapshots
+    chrono::steady_clock::time_point due;   // when the next snapshot is due
+    unsigned int countdown;                 // events until the clock is checked again
+    bool failed;                            // a snapshot could not be written
+
+public:
+    // CONSTRUCTOR - CHECKPOINT MODULE
+    // Saves "simulation" (replaying a workload with Hash() "hash") to "fileStr"
+    // every "seconds" seconds of wall clock time
+    Checkpoint_Module(Simulation_Module* simulation, uint64_t hash,
+                        const string& fileStr, double seconds) : fileName(fileStr) {
+        run = simulation;
+        workloadHash = hash;
+        interval = chrono::duration_cast<chrono::steady_clock::duration>(
+                        chrono::duration<double>(seconds));
+        due = chrono::steady_clock::now() + interval;
+        countdown = EVENTS_PER_CHECK;
+        failed = false;
+    }
+
+    // DE-CONSTRUCTOR - CHECKPOINT MODULE
+    ~Checkpoint_Module() { /* no implementation */ }
+
+    // TICK
+    // Called between two events; saves the run if a snapshot is due
+    void Tick() {
+        if (--countdown != 0)
+            return;
+        countdown = EVENTS_PER_CHECK;
+        if (chrono::steady_clock::now() >= due)
+            SaveNow();
+    }
+
+    // SAVE NOW
+    // Saves the run right away (false if the snapshot could not be written)
+    bool SaveNow() {
+        if (!Save(*run, workloadHash, fileName.c_str()) && !failed) {
+            cerr << "Could not write snapshot " << fileName << "\n";
+            failed = true;
+        }
+        due = chrono::steady_clock::now() + interval;
+        return !failed;
+    }
+
+    // SAVE
+    // Writes the state of "simulation", replaying a workload with Hash() "hash", to
+    // "fileStr" (through a temporary file that is renamed over it, so a crash never
+    // leaves a torn snapshot behind)
+    static bool Save(Simulation_Module& simulation, uint64_t hash,
+                        const char* fileStr) {
+        const Queue_Module& ready = simulation.queue[READY];
+        const JobTable_Module& jobs = simulation.jobs;
+        const Stats_Module& stats = simulation.stats;
+        const CPU_Module& cpu = simulation.cpu;
+        const Scheduler_Module& scheduler = simulation.scheduler;
+        Snapshot_Header header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, RR_SNAPSHOT_MAGIC, sizeof(RR_SNAPSHOT_MAGIC));
+        header.version = RR_SNAPSHOT_VERSION;
+        header.pcbSize = sizeof(Snapshot_PCB);
+        header.timeQuantum = cpu.time_quantum;
+        header.cpuTime = cpu.cpu_time;
+        header.currentSlot = (cpu.curr_process == JobTable_Module::NO_JOB) ?
+                                RR_SNAPSHOT_NO_SLOT : cpu.curr_process;
+        header.overhead = scheduler.serviceTime;
+        header.schedulerStart = scheduler.startTime;
+        header.schedulerEnd = scheduler.endTime;
+        header.schedulerState = (uint32_t)scheduler.state;
+        header.completed = scheduler.completed;
+        header.readyLengthSum = scheduler.readyQ_length_sum;
+        header.timesChecked = scheduler.timesChecked;
+        header.readyLength = ready.size;
+        header.readyMaxLength = ready.maxLength;
+        header.pcbs = jobs.used;
+        header.released = jobs.released.size();
+        const WorkloadSource_Module& replay = simulation.replay;
+        header.position = replay.position;
+        if (replay.workload != NULL) {
+            header.workloadSize = replay.workload->Size();
+            header.workloadHash = hash;
+        }
+        header.buckets = Histogram_Module::BUCKETS;
+        header.statsCompleted = stats.completed;
+        SplitSum(stats.turnTimeSum, header.turnTimeSum);
+        SplitSum(stats.waitTimeSum, header.waitTimeSum);
+        const Histogram_Module* histograms[3] = {
+            &stats.turnTimes, &stats.waitTimes, &stats.slowdowns
+        };
+        for (int h = 0; h < 3; h++) {
+            header.histograms[h].unit = histograms[h]->unit;
+            header.histograms[h].total = histograms[h]->total;
+            header.histograms[h].minValue = histograms[h]->minValue;
+            header.histograms[h].maxValue = histograms[h]->maxValue;
+        }
+        // the whole snapshot is assembled in memory and written in one go
+        string buffer;
+        buffer.reserve(Size(header));
+        buffer.append((const char*)&header, sizeof(header));
+        for (int h = 0; h < 3; h++)
+            buffer.append((const char*)histograms[h]->counts.data(),
+                            histograms[h]->counts.size() * sizeof(uint64_t));
+        for (size_t i = 0; i < jobs.used; i++) {
+            const uint32_t job = (uint32_t)i;
+            Snapshot_PCB pcb;
+            pcb.processId = jobs.GetProcessId(job);
+            pcb.arrivalTime = jobs.GetArrivalTime(job);
+            pcb.serviceTime = jobs.GetServiceTime(job);
+            pcb.timeLeft = jobs.GetTimeRemaining(job);
+            pcb.startTime = jobs.BeganExecution(job);
+            pcb.state = (uint32_t)jobs.GetProcessState(job);
+            pcb.reserved = 0;
+            buffer.append((const char*)&pcb, sizeof(pcb));
+        }
+        for (unsigned int i = 0; i < ready.size; i++) {
+            uint32_t slot = ready.ring[(ready.head + i) & (ready.ring.size() - 1)];
+            buffer.append((const char*)&slot, sizeof(slot));
+        }
+        buffer.append((const char*)jobs.released.data(),
+                        jobs.released.size() * sizeof(uint32_t));
+        return WriteFile(fileStr, buffer);
+    }
+
+    // RESTORE
+    // Puts "simulation" in the state saved in "fileStr", replaying "workload" (the
+    // workload the snapshot was taken on, with Hash() "hash") from where the
+    // snapshot left off. Returns false, leaving the run alone, if there is no such
+    // snapshot or it does not fit the workload.
+    static bool Restore(Simulation_Module& simulation, const Workload_Module& workload,
+                        uint64_t hash, const char* fileStr) {
+        int fd = open(fileStr, O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        void* map = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(Snapshot_Header))
+            map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+            cerr << fileStr << " is not a snapshot\n";
+            return false;
+        }
+        const char* bytes = (const char*)map;
+        const Snapshot_Header& header = *(const Snapshot_Header*)bytes;
+        bool ok = Check(header, (size_t)st.st_size, workload, hash, fileStr);
+        if (ok) {
+            const uint64_t* counts = (const uint64_t*)(bytes + sizeof(Snapshot_Header));
+            const Snapshot_PCB* pcbs = (const Snapshot_PCB*)(counts + 3 * header.buckets);
+            const uint32_t* ready = (const uint32_t*)(pcbs + header.pcbs);
+            const uint32_t* released = ready + header.readyLength;
+            ok = CheckSlots(header, pcbs, ready, released, fileStr);
+            if (ok)
+                Load(simulation, workload, header, counts, pcbs, ready, released);
+        }
+        munmap(map, (size_t)st.st_size);
+        return ok;
+    }
+
+private:
+    // SIZE
+    // Returns the size of the snapshot described by "header" [bytes]
+    static size_t Size(const Snapshot_Header& header) {
+        return sizeof(Snapshot_Header) + 3 * (size_t)header.buckets * sizeof(uint64_t) +
+                (size_t)header.pcbs * sizeof(Snapshot_PCB) +
+                ((size_t)header.readyLength + (size_t)header.released) * sizeof(uint32_t);
+    }
+
+    // SPLIT SUM
+    // Stores an exact sum as its low and high 64 bits
+    static void SplitSum(const ExactSum_Module& sum, uint64_t parts[2]) {
+        unsigned __int128 bits = (unsigned __int128)sum.sum;
+        parts[0] = (uint64_t)bits;
+        parts[1] = (uint64_t)(bits >> 64);
+    }
+
+    // JOIN SUM
+    // Rebuilds an exact sum from its low and high 64 bits
+    static void JoinSum(ExactSum_Module& sum, const uint64_t parts[2]) {
+        sum.sum = (__int128)(((unsigned __int128)parts[1] << 64) | parts[0]);
+    }
+
+    // CHECK
+    // Checks the header against the file size and the workload being replayed
+    static bool Check(const Snapshot_Header& header, size_t size,
+                        const Workload_Module& workload, uint64_t hash,
+                        const char* fileStr) {
+        if (memcmp(header.magic, RR_SNAPSHOT_MAGIC, sizeof(RR_SNAPSHOT_MAGIC)) != 0 ||
+                header.version != RR_SNAPSHOT_VERSION ||
+                header.pcbSize != sizeof(Snapshot_PCB) ||
+                header.buckets != (uint32_t)Histogram_Module::BUCKETS ||
+                header.released > header.pcbs || header.pcbs > 0xFFFFFFFFull ||
+                Size(header) != size) {
+            cerr << fileStr << " is not a snapshot\n";
+            return false;
+        }
+        if (header.workloadSize != workload.Size() || header.position > header.workloadSize ||
+                header.workloadHash != hash) {
+            cerr << fileStr << " was taken on a different workload\n";
+            return false;
+        }
+        return true;
+    }
+
+    // CHECK SLOTS
+    // Checks that every slot the snapshot refers to was handed out
+    static bool CheckSlots(const Snapshot_Header& header, const Snapshot_PCB* pcbs,
+                            const uint32_t* ready, const uint32_t* released,
+                            const char* fileStr) {
+        bool ok = (header.currentSlot == RR_SNAPSHOT_NO_SLOT ||
+                    header.currentSlot < header.pcbs);
+        for (uint32_t i = 0; ok && i < header.readyLength; i++)
+            ok = (ready[i] < header.pcbs);
+        for (uint64_t i = 0; ok && i < header.released; i++)
+            ok = (released[i] < header.pcbs);
+        for (uint64_t i = 0; ok && i < header.pcbs; i++)
+            ok = (pcbs[i].state <= PCB_Module::PS_TERMINATED);
+        if (!ok)
+            cerr << fileStr << " is corrupt\n";
+        return ok;
+    }
+
+    // LOAD
+    // Copies the (checked) sections of a snapshot into "simulation"
+    static void Load(Simulation_Module& simulation, const Workload_Module& workload,
+                        const Snapshot_Header& header, const uint64_t* counts,
+                        const Snapshot_PCB* pcbs, const uint32_t* ready,
+                        const uint32_t* released) {
+        simulation.Reset(header.timeQuantum, header.overhead);
+        simulation.Load(workload);
+        simulation.replay.position = (unsigned int)header.position;
+        // ==== job table ==== //
+        JobTable_Module& jobs = simulation.jobs;
+        jobs.Reserve((size_t)header.pcbs);
+        for (uint64_t i = 0; i < header.pcbs; i++) {
+            const Snapshot_PCB& pcb = pcbs[i];
+            jobs.Restore((uint32_t)i, pcb.processId, pcb.arrivalTime, pcb.serviceTime,
+                            pcb.timeLeft, pcb.startTime,
+                            (PCB_Module::ProcessState_t)pcb.state);
+        }
+        jobs.used = (size_t)header.pcbs;
+        jobs.released.assign(released, released + header.released);
+        // ==== ready queue ==== //
+        Queue_Module& readyQ = simulation.queue[READY];
+        for (uint32_t i = 0; i < header.readyLength; i++)
+            readyQ.Enqueue(ready[i]);
+        readyQ.maxLength = header.readyMaxLength;
+        // ==== cpu ==== //
+        CPU_Module& cpu = simulation.cpu;
+        cpu.cpu_time = header.cpuTime;
+        cpu.curr_process = (header.currentSlot == RR_SNAPSHOT_NO_SLOT) ?
+                            JobTable_Module::NO_JOB : header.currentSlot;
+        cpu.saved_process = JobTable_Module::NO_JOB;
+        cpu.handler = NULL;
+        // ==== scheduler ==== //
+        Scheduler_Module& scheduler = simulation.scheduler;
+        scheduler.startTime = header.schedulerStart;
+        scheduler.endTime = header.schedulerEnd;
+        scheduler.state = (PCB_Module::ProcessState_t)header.schedulerState;
+        scheduler.completed = header.completed;
+        scheduler.readyQ_length_sum = header.readyLengthSum;
+        scheduler.timesChecked = header.timesChecked;
+        // ==== statistics ==== //
+        Stats_Module& stats = simulation.stats;
+        stats.completed = header.statsCompleted;
+        JoinSum(stats.turnTimeSum, header.turnTimeSum);
+        JoinSum(stats.waitTimeSum, header.waitTimeSum);
+        Histogram_Module* histograms[3] = {
+            &stats.turnTimes, &stats.waitTimes, &stats.slowdowns
+        };
+        for (int h = 0; h < 3; h++) {
+            histograms[h]->unit = header.histograms[h].unit;
+            histograms[h]->total = header.histograms[h].total;
+            histograms[h]->minValue = header.histograms[h].minValue;
+            histograms[h]->maxValue = header.histograms[h].maxValue;
+            memcpy(histograms[h]->counts.data(), counts + h * (size_t)header.buckets,
+                    (size_t)header.buckets * sizeof(uint64_t));
+        }
+    }
+
+    // WRITE FILE
+    // Writes "buffer" to "fileStr" through a temporary file
+    static bool WriteFile(const char* fileStr, const string& buffer) {
+        string temporary = string(fileStr) + ".tmp";
+        int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            return false;
+        const char* bytes = buffer.data();
+        size_t length = buffer.size();
+        while (length > 0) {
+            ssize_t n = write(fd, bytes, length);
+            if (n <= 0)
+                break;
+            bytes += n;
+            length -= (size_t)n;
+        }
+        bool ok = (length == 0 && fsync(fd) == 0);
+        ok = (close(fd) == 0) && ok;
+        if (ok && rename(temporary.c_str(), fileStr) == 0)
+            return true;
+        unlink(temporary.c_str());
+        return false;
+    }
+};
+
+#endif // RR_CHECKPOINT_MODULE_H_
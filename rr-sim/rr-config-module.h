@@ -0,0 +1,60 @@
+#ifndef RR_CONFIG_MODULE_H_
+#define RR_CONFIG_MODULE_H_
+
+#include <cmath>
+using namespace std;
+
+// The outcome of a simulator call. Errors are reported as one of these rather
+// than by ending the program, so the simulator can live inside a host program.
+enum Sim_Status_t {
+    SS_OK = 0,
+    SS_NO_INPUT,            // no input file was given
+    SS_UNREADABLE_INPUT,    // the input file could not be read or parsed
+    SS_BAD_TIME_QUANTUM,    // the time quantum is not a positive, finite number
+    SS_BAD_OVERHEAD,        // the overhead is negative or not finite
+    SS_BAD_WORKLOAD,        // a process has a negative or non-finite time, or arrives
+                            // before the process ahead of it
+    SS_BAD_OUTPUT           // an output stream could not be written
+};
+
+// STATUS MESSAGE
+// Returns a description of "status" (for error messages)
+inline const char* StatusMessage(Sim_Status_t status) {
+    switch (status) {
+        case SS_OK:                 return "ok";
+        case SS_NO_INPUT:           return "the input file was not specified";
+        case SS_UNREADABLE_INPUT:   return "the input file could not be read";
+        case SS_BAD_TIME_QUANTUM:   return "the time quantum must be positive";
+        case SS_BAD_OVERHEAD:       return "the overhead must not be negative";
+        case SS_BAD_WORKLOAD:       return "the processes must arrive in order, at "
+                                           "finite, non-negative times";
+        case SS_BAD_OUTPUT:         return "an output file could not be written";
+    }
+    return "unknown error";
+}
+
+// The configuration of one simulation (one grid cell) run through simulate()
+struct Sim_Config {
+    float timeQuantum;          // the round robin time quantum [secs]
+    float overhead;             // the scheduler overhead [secs]
+    bool fastForward;           // skip over the quanta whose outcome is known
+
+    // CONSTRUCTOR - SIM CONFIG
+    Sim_Config(float tq = 0.1f, float ov = 0.0f) {
+        timeQuantum = tq;
+        overhead = ov;
+        fastForward = true;
+    }
+
+    // VALIDATE
+    // Returns SS_OK if the configuration can be simulated, or what is wrong with it
+    Sim_Status_t Validate() const {
+        if (!(timeQuantum > 0.0f) || !isfinite(timeQuantum))
+            return SS_BAD_TIME_QUANTUM;
+        if (!(overhead >= 0.0f) || !isfinite(overhead))
+            return SS_BAD_OVERHEAD;
+        return SS_OK;
+    }
+};
+
+#endif // RR_CONFIG_MODULE_H_
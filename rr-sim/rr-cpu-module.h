@@ -1,90 +1,145 @@
 #ifndef RR_CPU_MODULE_H_
 #define RR_CPU_MODULE_H_
 
+#include <cassert>
+
 #include "rr-pcb-module.h"
+#include "rr-jobtable-module.h"
+#include "rr-profile-module.h"
 
+// The CPU runs the jobs of a job table (by slot) and, on an interrupt, the handler
+// (the scheduler's PCB) while the interrupted job is saved
 class CPU_Module {
 private:
-    float cpu_time;             // holds the (current) CPU time
+    double cpu_time;            // holds the (current) CPU time (a float clock
+                                // drifts or stalls past ~1e6 secs)
     float time_quantum;         // holds the Round Robin time quantum
-    PCB_Module* curr_process;   // points to the current (running) process
-    PCB_Module* saved_process;  // points to the saved (not-running) process
+    JobTable_Module* jobs;      // the jobs the CPU runs
+    uint32_t curr_process;      // the current (running) job (NO_JOB if none)
+    uint32_t saved_process;     // the saved (not-running) job (NO_JOB if none)
+    PCB_Module* handler;        // the interrupt handler running (NULL if none)
     
     // Allows Scheduler_Module class to manipulate this class
     friend class Scheduler_Module;
+    // Allows snapshots to save and restore this class
+    friend class Checkpoint_Module;
 
 public:
     // CONSTRUCTOR - CPU MODULE
-    CPU_Module(float tq = 20.0f) {
-        cpu_time = 0.0f;
+    CPU_Module(JobTable_Module* job_table, float tq = 20.0f) {
+        // the parts are wired together by Simulation_Module (never missing)
+        assert(job_table != NULL);
+        jobs = job_table;
+        cpu_time = 0.0;
         time_quantum = tq;
-        curr_process = NULL;
+        curr_process = JobTable_Module::NO_JOB;
+        saved_process = JobTable_Module::NO_JOB;
+        handler = NULL;
     }
 
     // DE-CONSTRUCTOR - CPU MODULE
     ~CPU_Module() { /* no implementation */ }
 
+    // RESET
+    // Puts the CPU back in its initial state with a (new) time quantum
+    void Reset(float tq) {
+        cpu_time = 0.0;
+        time_quantum = tq;
+        curr_process = JobTable_Module::NO_JOB;
+        saved_process = JobTable_Module::NO_JOB;
+        handler = NULL;
+    }
+
+    // SET TIME QUANTUM
+    // Changes the (round robin) time quantum from the next time slice on
+    void SetTimeQuantum(float tq) {
+        time_quantum = tq;
+    }
+
     // GET CPU TIME
     // Returns the current CPU (clock) time
-    float GetCpuTime() {
+    double GetCpuTime() {
         return cpu_time;
     }
 
     // EXECUTE PROCESS
-    // "Executes" the current process and returns the clock time after process execution
-    float Execute() {
-        if (curr_process == NULL)
+    // "Executes" the current process (or the interrupt handler) and returns the clock
+    // time after process execution
+    double Execute() {
+        if (handler != NULL)
+            return ExecuteHandler();
+        if (curr_process == JobTable_Module::NO_JOB)
             return -1;
+        Profile_Timer timer(PP_EXECUTE);
+        Profile_Module::Count(PC_QUANTA);
         // 1. get the service time remaining for a process
-        float time_left = curr_process->GetTimeRemaining();
+        float time_left = jobs->GetTimeRemaining(curr_process);
         // 2.A. the time remaining is greater than or equal to the time quantum
         if (time_left >= time_quantum) {
             cpu_time += time_quantum;
-            curr_process->Fire (time_quantum);
+            jobs->Fire (curr_process, time_quantum);
         // 2.B. the time remaining is less than the time quantum
         } else {
             cpu_time += time_left;
-            curr_process->Fire (time_left);
+            jobs->Fire (curr_process, time_left);
         }
         return cpu_time;
     }
     
+    // SLICE
+    // Returns how long the current process will run during its next Execute()
+    float Slice() {
+        if (curr_process == JobTable_Module::NO_JOB)
+            return 0.0f;
+        float time_left = jobs->GetTimeRemaining(curr_process);
+        return (time_left >= time_quantum) ? time_quantum : time_left;
+    }
+    
+    // SLICE END
+    // Returns the clock time at which the current process's next Execute() ends
+    double SliceEnd() {
+        return cpu_time + Slice();
+    }
+    
     // FAST FORWARD CLOCK TO
     // Advances the CPU clock a new clock time (greater than the current one)
-    float FastForwardClockTo(float newCpuTime) {
-        if (newCpuTime > cpu_time)
+    double FastForwardClockTo(double newCpuTime) {
+        if (newCpuTime > cpu_time) {
             cpu_time = newCpuTime;
+            Profile_Module::Count(PC_IDLE_FAST_FORWARDS);
+        }
         return cpu_time;
     }
     
     // LOAD PROCESS
     // Loads the saved process and makes it the current process
     void LoadProcess() {
-        if (saved_process != NULL) {
+        if (saved_process != JobTable_Module::NO_JOB) {
             curr_process = saved_process;
-            saved_process = NULL;
+            saved_process = JobTable_Module::NO_JOB;
         }
     }
     
     // SAVE PROCESS
     // Saves the current process (using the saved_process variable)
     void SaveProcess() {
-        if (curr_process != NULL) {
+        if (curr_process != JobTable_Module::NO_JOB) {
             saved_process = curr_process;
-            curr_process = NULL;
+            curr_process = JobTable_Module::NO_JOB;
         }
     }
     
     // INTERRUPT
     // Simulates a CPU interrupt and uses "process" to handle the interrupt (scheduler)
-    float Interrupt(PCB_Module* process) {
+    double Interrupt(PCB_Module* process) {
+        Profile_Timer timer(PP_INTERRUPT);
         // 1. save the current process
         SaveProcess();
-        // 2. make the current process the new process "process" (scheduler)
-        curr_process = process;
-        // 3. execute the current process
+        // 2. make the new process "process" (scheduler) the handler
+        handler = process;
+        // 3. execute the handler
         Execute();
-        curr_process = NULL;
+        handler = NULL;
         // 4. load the saved process (make it the current process)
         LoadProcess();
         return cpu_time;
@@ -99,13 +154,30 @@ public:
     // BUSY
     // Returns the CPU's current state (if it is currently occupied by a process or not)
     bool Busy() {
-        return (curr_process != NULL);
+        return (curr_process != JobTable_Module::NO_JOB || handler != NULL);
     }
     
     // INTERRUPTED
     // Returns the CPU's interrupted state (checks if a process was saved)
     bool Interrupted() {
-        return (saved_process != NULL);
+        return (saved_process != JobTable_Module::NO_JOB);
+    }
+
+private:
+    // EXECUTE HANDLER
+    // Runs the interrupt handler for its time left (capped at one time quantum)
+    double ExecuteHandler() {
+        Profile_Timer timer(PP_EXECUTE);
+        Profile_Module::Count(PC_SCHEDULER_RUNS);
+        float time_left = handler->GetTimeRemaining();
+        if (time_left >= time_quantum) {
+            cpu_time += time_quantum;
+            handler->Fire (time_quantum);
+        } else {
+            cpu_time += time_left;
+            handler->Fire (time_left);
+        }
+        return cpu_time;
     }
 };
 
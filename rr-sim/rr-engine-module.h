@@ -0,0 +1,284 @@
+#ifndef RR_ENGINE_MODULE_H_
+#define RR_ENGINE_MODULE_H_
+
+#include <vector>
+#include <cmath>
+#include <stdint.h>
+#include <cassert>
+using namespace std;
+
+#include "rr-queue-module.h"
+#include "rr-source-module.h"
+#include "rr-stats-module.h"
+
+// ==== QUANTUM POLICIES ============================================================== //
+// A time quantum known at compile time (in microseconds, so it can be a template
+// argument); the quantum is the nearest float, exactly like the literal 0.05f etc.
+template <unsigned int MICROSECONDS>
+struct FixedQuantum_Policy {
+    static constexpr float QUANTUM = (float)MICROSECONDS / 1000000.0f;
+
+    void Set(float) { /* fixed */ }
+    static constexpr float Get() { return QUANTUM; }
+};
+
+// A time quantum chosen at run time
+struct VariableQuantum_Policy {
+    float quantum;
+
+    void Set(float timeQuantum) { quantum = timeQuantum; }
+    float Get() const { return quantum; }
+};
+
+// ==== OVERHEAD POLICIES ============================================================= //
+// The scheduler runs in no time: the engine never touches the clock for it
+struct NoOverhead_Policy {
+    static constexpr bool ZERO = true;
+
+    void Set(float, float) { /* nothing to set */ }
+    float Step() const { return 0.0f; }
+    float Full() const { return 0.0f; }
+};
+
+// The scheduler runs for a fixed overhead after every time slice, capped at one
+// quantum (like Scheduler_Module executed through CPU_Module::Execute)
+struct FixedOverhead_Policy {
+    static constexpr bool ZERO = false;
+    float overhead;     // the scheduler overhead
+    float step;         // the time the scheduler actually runs for
+
+    void Set(float overheadTime, float timeQuantum) {
+        overhead = overheadTime;
+        step = (overheadTime >= timeQuantum) ? timeQuantum : overheadTime;
+    }
+    float Step() const { return step; }
+    float Full() const { return overhead; }
+};
+
+// ==== SCHEDULER POLICIES ============================================================ //
+// Round robin: preempted jobs go to the back of the ready queue and the front of
+// the queue runs next. Jobs are indices into the engine's job table.
+class RoundRobin_Policy {
+private:
+    Queue_Module queue;     // the ready queue
+
+public:
+    // RESET
+    // Empties the ready queue and forgets its max length
+    void Reset() {
+        queue.Reset();
+    }
+
+    // PUSH
+    // Adds an arriving or preempted job to the back of the ready queue
+    void Push(uint32_t job) {
+        queue.Enqueue(job);
+    }
+
+    // POP
+    // Removes and returns the job that runs next
+    uint32_t Pop() {
+        return queue.Dequeue();
+    }
+
+    // LENGTH
+    // Returns the length of the ready queue
+    unsigned int Length() const {
+        return queue.Length();
+    }
+
+    // MAX LENGTH
+    // Returns the maximum length of the ready queue
+    unsigned int MaxLength() const {
+        return queue.MaxLength();
+    }
+
+    // EMPTY
+    // Returns true if no job is ready
+    bool Empty() const {
+        return queue.Empty();
+    }
+};
+
+// The simulation with its policies fixed at compile time. The CPU is the engine's
+// own clock and running job, the scheduler is the Scheduler_Policy and the
+// scheduler run after every time slice comes from the Overhead_Policy, so a time
+// slice is a few inlined clock operations: no virtual Fire(), no interrupt that
+// saves, runs and reloads processes through the CPU, and no PCB objects (jobs live
+// in a table of columns that reuses the slots of finished jobs; a time slice only
+// touches the time left column). The arithmetic is done in
+// the same order as CPU_Module/Scheduler_Module (which remain the reference
+// implementation), so the results are identical to theirs.
+template <class Quantum_Policy, class Overhead_Policy,
+            class Scheduler_Policy = RoundRobin_Policy>
+class Engine_Module {
+private:
+    // the cold state of a job in the system (its time left is a column of its own)
+    struct Job {
+        float arrivalTime;      // arrival time [CPU clock]
+        float serviceTime;      // amount of time the job needs to execute
+        double startTime;       // time the job first ran [CPU clock]
+    };
+
+    Quantum_Policy quantum;         // the CPU's time quantum
+    Overhead_Policy overhead;       // the scheduler run after every time slice
+    Scheduler_Policy readyQ;        // the ready queue
+    vector<float> timeLeft;         // the job table: time left to service (hot)
+    vector<Job> jobs;               // the job table: the rest of each job (cold)
+    vector<uint32_t> freeSlots;     // slots of finished jobs, reused first
+    Source_Module* arrivals;        // where jobs arrive from
+    bool pending;                   // more jobs will arrive
+    float nextArrival;              // arrival time of the next job (if pending)
+    Stats_Module* stats;            // records jobs as they finish
+    double clock;                   // the CPU clock
+    int64_t readyQ_length_sum;      // sum of the length of the ready queue at dispatch
+    int64_t timesChecked;           // amount of dispatches
+
+    // the engine points at its source while running, so it is never copied
+    Engine_Module(const Engine_Module&) = delete;
+    Engine_Module& operator=(const Engine_Module&) = delete;
+
+public:
+    // CONSTRUCTOR - ENGINE MODULE
+    Engine_Module(Stats_Module* done_stats) {
+        assert(done_stats != NULL);
+        stats = done_stats;
+        Reset(0.0f, 0.0f);
+    }
+
+    // RESET
+    // Configures the engine for a new (time quantum, overhead) run
+    void Reset(float timeQuantum, float overheadTime) {
+        quantum.Set(timeQuantum);
+        overhead.Set(overheadTime, quantum.Get());
+        readyQ.Reset();
+        timeLeft.clear();
+        jobs.clear();
+        freeSlots.clear();
+        arrivals = NULL;
+        pending = false;
+        nextArrival = HUGE_VALF;
+        clock = 0.0;
+        readyQ_length_sum = 0;
+        timesChecked = 0;
+    }
+
+    // RUN
+    // Simulates every job arriving from "source" until the system is empty
+    void Run(Source_Module& source) {
+        arrivals = &source;
+        PeekNextArrival();
+        uint32_t running = 0;
+        bool busy = false;
+        while (true) {
+            // 1. the CPU idles: fast fwd the clock to the next arrival and run it
+            if (!busy) {
+                if (!pending)
+                    break;
+                if (nextArrival > clock)
+                    clock = nextArrival;
+                AdmitNextJob();
+                busy = Dispatch(running);
+            }
+            // 2. execute the running job for (at most) one quantum
+            const float tq = quantum.Get();
+            float left = timeLeft[running];
+            if (left >= tq) {
+                clock += tq;
+                left -= tq;
+            } else {
+                clock += left;
+                left -= left;
+            }
+            timeLeft[running] = left;
+            // 3. the scheduler runs: admit the jobs that arrived meanwhile
+            if constexpr (!Overhead_Policy::ZERO)
+                clock += overhead.Step();
+            while (pending && nextArrival <= clock)
+                AdmitNextJob();
+            // 4. evaluate the preempted job and dispatch the next one
+            if (left > 0.0f) {
+                readyQ.Push(running);
+            } else {
+                Retire(running);
+                // the last scheduler run of the simulation is not part of it
+                if constexpr (!Overhead_Policy::ZERO) {
+                    if (readyQ.Empty() && !pending)
+                        clock -= overhead.Full();
+                }
+            }
+            busy = Dispatch(running);
+        }
+        arrivals = NULL;
+    }
+
+    // METRICS
+    // Returns the deliverables of the (finished) run
+    Run_Metrics Metrics() {
+        Run_Metrics metrics;
+        metrics.overhead = overhead.Full();
+        metrics.timeQuantum = quantum.Get();
+        metrics.maxReadyLength = readyQ.MaxLength();
+        metrics.avgReadyLength = (timesChecked > 0) ?
+                            (float)readyQ_length_sum / (float)timesChecked : 0.0f;
+        metrics.cpuTime = clock;
+        metrics.dispatches = (unsigned long long)timesChecked;
+        metrics.stats = stats;
+        return metrics;
+    }
+
+private:
+    // PEEK NEXT ARRIVAL
+    // Caches whether (and when) the next job arrives
+    void PeekNextArrival() {
+        const Process_t* next = arrivals->Peek();
+        pending = (next != NULL);
+        nextArrival = pending ? next->arrivalTime : HUGE_VALF;
+    }
+
+    // ADMIT NEXT JOB
+    // Adds the next arriving job to the job table and the ready queue
+    void AdmitNextJob() {
+        const Process_t* next = arrivals->Peek();
+        Job job = { next->arrivalTime, next->serviceTime, 0.0f };
+        arrivals->Pop();
+        uint32_t slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+            timeLeft[slot] = job.serviceTime;
+            jobs[slot] = job;
+        } else {
+            slot = (uint32_t)jobs.size();
+            timeLeft.push_back(job.serviceTime);
+            jobs.push_back(job);
+        }
+        readyQ.Push(slot);
+        PeekNextArrival();
+    }
+
+    // DISPATCH
+    // Takes the next job off the ready queue (false if there is none)
+    bool Dispatch(uint32_t& running) {
+        if (readyQ.Empty())
+            return false;
+        readyQ_length_sum += (int64_t)readyQ.Length();
+        timesChecked++;
+        running = readyQ.Pop();
+        Job& job = jobs[running];
+        if (timeLeft[running] == job.serviceTime)
+            job.startTime = clock;
+        return true;
+    }
+
+    // RETIRE
+    // Records a finished job and frees its slot
+    void Retire(uint32_t slot) {
+        const Job& job = jobs[slot];
+        stats->Record(clock - job.arrivalTime, job.startTime - job.arrivalTime,
+                        job.serviceTime);
+        freeSlots.push_back(slot);
+    }
+};
+
+#endif // RR_ENGINE_MODULE_H_
@@ -0,0 +1,63 @@
+#ifndef RR_EVENT_MODULE_H_
+#define RR_EVENT_MODULE_H_
+
+using namespace std;
+
+// An event of the simulation
+struct Event_t {
+    // Describes what happens at the event's time
+    enum EventType_t {
+        EV_ARRIVAL = 0,         // a process arrives (only scheduled while the CPU idles)
+        EV_SLICE_END            // the running process's time slice is over
+    };
+
+    double time;                // when the event happens [CPU clock]
+    EventType_t type;           // what happens
+};
+
+// The pending event of a run. A single CPU only ever has one event pending: the end
+// of the running process's time slice or, while it idles, the next arrival (a busy
+// CPU's scheduler picks arrivals up when it runs), so the event set is one slot.
+class NextEvent_Module {
+private:
+    Event_t next;       // the pending event
+    bool pending;       // an event is pending
+
+public:
+    // CONSTRUCTOR - NEXT EVENT MODULE
+    NextEvent_Module() {
+        Reset();
+    }
+
+    // RESET
+    // Drops the pending event
+    void Reset() {
+        pending = false;
+    }
+
+    // EMPTY
+    // Returns true if no event is pending
+    bool Empty() const {
+        return !pending;
+    }
+
+    // SCHEDULE
+    // Makes an event the pending one (the previous one must have been taken)
+    void Schedule(double time, Event_t::EventType_t type) {
+        next.time = time;
+        next.type = type;
+        pending = true;
+    }
+
+    // NEXT
+    // Takes the pending event (false if there is none)
+    bool Next(Event_t& event) {
+        if (!pending)
+            return false;
+        event = next;
+        pending = false;
+        return true;
+    }
+};
+
+#endif // RR_EVENT_MODULE_H_
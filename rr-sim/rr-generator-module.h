@@ -0,0 +1,377 @@
+#ifndef RR_GENERATOR_MODULE_H_
+#define RR_GENERATOR_MODULE_H_
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cmath>
+#include <cstdlib>
+#include <stdint.h>
+using namespace std;
+
+#include "rr-source-module.h"
+#include "rr-workload-module.h"
+
+// Describes a synthetic workload
+struct Generator_Config {
+    // How processes arrive
+    enum Arrivals_t {
+        ARR_POISSON = 0,    // exponential interarrival times
+        ARR_ONOFF           // bursts of Poisson arrivals separated by idle periods
+    };
+    // How long processes need to execute
+    enum Service_t {
+        SRV_EXPONENTIAL = 0,    // exponential with mean "meanService"
+        SRV_PARETO,             // Pareto with mean "meanService" and shape "alpha"
+        SRV_BIMODAL             // "shortService" or (with "longFraction") "longService"
+    };
+
+    unsigned long long jobs;    // number of processes
+    unsigned long long seed;    // the same seed always gives the same workload
+    double utilization;         // target CPU utilization (mean service / mean gap)
+    Arrivals_t arrivals;
+    Service_t service;
+    double meanService;         // [secs] (exponential, Pareto)
+    double alpha;               // Pareto shape (> 1)
+    double shortService;        // [secs] (bimodal)
+    double longService;         // [secs] (bimodal)
+    double longFraction;        // fraction of long processes (bimodal)
+    double burstJobs;           // mean processes per burst (on/off)
+    double peakFactor;          // arrival rate during a burst / mean arrival rate
+
+    // CONSTRUCTOR - GENERATOR CONFIG
+    // Poisson arrivals of exponential processes (mean 1 sec) at 90% utilization
+    Generator_Config() {
+        jobs = 1000000;
+        seed = 1;
+        utilization = 0.9;
+        arrivals = ARR_POISSON;
+        service = SRV_EXPONENTIAL;
+        meanService = 1.0;
+        alpha = 2.5;
+        shortService = 0.1;
+        longService = 10.0;
+        longFraction = 0.05;
+        burstJobs = 100.0;
+        peakFactor = 5.0;
+    }
+
+    // MEAN SERVICE TIME
+    // Returns the mean service time of the configured distribution
+    double MeanServiceTime() const {
+        if (service == SRV_BIMODAL)
+            return (1.0 - longFraction) * shortService + longFraction * longService;
+        return meanService;
+    }
+
+    // PARSE
+    // Reads a comma separated "key=value" list (e.g. "jobs=1e6,service=pareto,
+    // alpha=1.5"), keeping the defaults for missing keys; false if malformed
+    bool Parse(const string& spec) {
+        stringstream list(spec);
+        string item;
+        while (getline(list, item, ',')) {
+            size_t eq = item.find('=');
+            if (eq == string::npos)
+                return false;
+            string key = item.substr(0, eq), value = item.substr(eq + 1);
+            char* end = NULL;
+            double number = strtod(value.c_str(), &end);
+            bool numeric = !value.empty() && *end == '\0';
+            if (key == "arrivals" && value == "poisson")
+                arrivals = ARR_POISSON;
+            else if (key == "arrivals" && value == "onoff")
+                arrivals = ARR_ONOFF;
+            else if (key == "service" && value == "exp")
+                service = SRV_EXPONENTIAL;
+            else if (key == "service" && value == "pareto")
+                service = SRV_PARETO;
+            else if (key == "service" && value == "bimodal")
+                service = SRV_BIMODAL;
+            else if (!numeric || number < 0.0)
+                return false;
+            else if (key == "jobs")
+                jobs = (unsigned long long)number;
+            else if (key == "seed")
+                seed = (unsigned long long)number;
+            else if (key == "util")
+                utilization = number;
+            else if (key == "mean")
+                meanService = number;
+            else if (key == "alpha")
+                alpha = number;
+            else if (key == "short")
+                shortService = number;
+            else if (key == "long")
+                longService = number;
+            else if (key == "plong")
+                longFraction = number;
+            else if (key == "burst")
+                burstJobs = number;
+            else if (key == "peak")
+                peakFactor = number;
+            else
+                return false;
+        }
+        return utilization > 0.0 && MeanServiceTime() > 0.0 &&
+                (service != SRV_PARETO || alpha > 1.0) && longFraction <= 1.0 &&
+                burstJobs >= 1.0 && peakFactor >= 1.0;
+    }
+};
+
+// Generates a synthetic workload on the fly, so huge runs never touch the disk.
+// The processes are produced in chunks by background threads, a bounded number of
+// chunks ahead of the simulation. Every chunk draws from its own random stream
+// (derived from the seed and the chunk's index) and holds arrival times relative
+// to its first gap, so chunks can be generated in any order by any number of
+// threads and the workload only depends on the configuration.
+class Generator_Module : public Source_Module {
+private:
+    static const size_t CHUNK_SIZE = 65536;     // processes per chunk
+
+    struct Chunk {
+        unsigned long long index;   // the chunk's position in the workload
+        bool ready;                 // the chunk has been generated
+        vector<double> offsets;     // arrival times relative to the previous chunk
+        vector<float> services;     // service times
+    };
+
+    Generator_Config config;
+    double meanGap;                 // mean interarrival time (at the target utilization)
+    double burstGap;                // mean interarrival time during a burst
+    double idleProbability;         // chance that a gap ends a burst (on/off)
+    double meanIdle;                // mean idle period between bursts (on/off)
+    double paretoScale;             // Pareto minimum (x_m)
+    unsigned long long chunks;      // number of chunks in the workload
+    vector<Chunk> window;           // the chunks in flight (chunk k in slot k % size)
+    vector<thread> workers;         // the generating threads
+    mutex lock;                     // guards the chunk indices and flags below
+    condition_variable generated;   // signalled when a chunk is ready
+    condition_variable consumed;    // signalled when a chunk is handed back
+    unsigned long long nextToGenerate;  // the next chunk a worker will take
+    unsigned long long current;         // the chunk being consumed
+    bool stopping;                  // the source is being destroyed
+    bool haveChunk;                 // "current" is ready and owned by the consumer
+    size_t position;                // index of the next process in the current chunk
+    double base;                    // arrival time the current chunk is relative to
+    Process_t process;              // the process returned by Peek()
+
+    // the worker threads point at this object, so it is never copied
+    Generator_Module(const Generator_Module&) = delete;
+    Generator_Module& operator=(const Generator_Module&) = delete;
+
+public:
+    // CONSTRUCTOR - GENERATOR MODULE
+    // Starts generating "configuration" on "threads" threads (0 = one per core)
+    Generator_Module(const Generator_Config& configuration, unsigned int threads = 0)
+        : config(configuration)
+    {
+        double meanService = config.MeanServiceTime();
+        meanGap = meanService / config.utilization;
+        burstGap = meanGap;
+        idleProbability = 0.0;
+        meanIdle = 0.0;
+        if (config.arrivals == Generator_Config::ARR_ONOFF) {
+            // a burst of "burstJobs" processes arrives "peakFactor" times faster
+            // than the mean rate; the idle periods make up the difference
+            burstGap = meanGap / config.peakFactor;
+            idleProbability = 1.0 / config.burstJobs;
+            meanIdle = config.burstJobs * (meanGap - burstGap);
+        }
+        paretoScale = config.meanService * (config.alpha - 1.0) / config.alpha;
+        chunks = (config.jobs + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        if (threads == 0)
+            threads = thread::hardware_concurrency();
+        if (threads == 0)
+            threads = 1;
+        window.resize(2 * threads + 2);
+        for (size_t i = 0; i < window.size(); i++)
+            window[i].ready = false;
+        nextToGenerate = 0;
+        current = 0;
+        stopping = false;
+        haveChunk = false;
+        position = 0;
+        base = 0.0;
+        for (unsigned int i = 0; i < threads; i++)
+            workers.push_back(thread(&Generator_Module::WorkerLoop, this));
+    }
+
+    // DE-CONSTRUCTOR - GENERATOR MODULE
+    virtual ~Generator_Module() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        consumed.notify_all();
+        for (size_t i = 0; i < workers.size(); i++)
+            workers[i].join();
+    }
+
+    // PEEK
+    // Returns the next process to arrive, waiting for the workers if they are
+    // behind (NULL once every process has been handed out)
+    virtual const Process_t* Peek() {
+        if (!haveChunk || position == window[current % window.size()].services.size()) {
+            if (!NextChunk())
+                return NULL;
+        }
+        const Chunk& chunk = window[current % window.size()];
+        process.processId = (unsigned int)(current * CHUNK_SIZE + position);
+        process.arrivalTime = (float)(base + chunk.offsets[position]);
+        process.serviceTime = chunk.services[position];
+        return &process;
+    }
+
+    // POP
+    // Consumes the process returned by Peek()
+    virtual void Pop() {
+        position++;
+    }
+
+    // FILL
+    // Hands out every (remaining) process into "workload"
+    void Fill(Workload_Module& workload) {
+        workload.Reserve(workload.Size() + (size_t)config.jobs);
+        const Process_t* next;
+        while ((next = Peek()) != NULL) {
+            workload.AddProcess(next->arrivalTime, next->serviceTime);
+            Pop();
+        }
+    }
+
+private:
+    // NEXT CHUNK
+    // Hands the consumed chunk back to the workers and waits for the next one
+    bool NextChunk() {
+        unique_lock<mutex> guard(lock);
+        if (haveChunk) {
+            Chunk& done = window[current % window.size()];
+            base += done.offsets.back();
+            done.ready = false;
+            current++;
+            haveChunk = false;
+            consumed.notify_all();
+        }
+        if (current >= chunks)
+            return false;
+        Chunk& next = window[current % window.size()];
+        while (!(next.ready && next.index == current))
+            generated.wait(guard);
+        haveChunk = true;
+        position = 0;
+        return true;
+    }
+
+    // WORKER LOOP
+    // Generates chunks, never running more than the window ahead of the consumer
+    void WorkerLoop() {
+        while (true) {
+            unsigned long long index;
+            {
+                unique_lock<mutex> guard(lock);
+                while (!stopping && nextToGenerate < chunks &&
+                        nextToGenerate >= current + window.size())
+                    consumed.wait(guard);
+                if (stopping || nextToGenerate >= chunks)
+                    return;
+                index = nextToGenerate++;
+            }
+            // the slot is free: its previous chunk was consumed (see above)
+            Chunk& chunk = window[index % window.size()];
+            Generate(index, chunk);
+            {
+                lock_guard<mutex> guard(lock);
+                chunk.index = index;
+                chunk.ready = true;
+            }
+            generated.notify_all();
+        }
+    }
+
+    // GENERATE
+    // Fills "chunk" with the processes of chunk "index"
+    void Generate(unsigned long long index, Chunk& chunk) {
+        size_t count = (size_t)min<unsigned long long>(CHUNK_SIZE,
+                                                        config.jobs - index * CHUNK_SIZE);
+        chunk.offsets.resize(count);
+        chunk.services.resize(count);
+        // xoshiro256** seeded (through splitmix64) with the seed and chunk index
+        uint64_t state[4];
+        uint64_t seed = config.seed * 0x9E3779B97F4A7C15ull + index;
+        for (int i = 0; i < 4; i++)
+            state[i] = SplitMix(seed);
+        double clock = 0.0;
+        for (size_t i = 0; i < count; i++) {
+            double gap = Exponential(state, burstGap);
+            if (idleProbability > 0.0 && Uniform(state) < idleProbability)
+                gap += Exponential(state, meanIdle);
+            clock += gap;
+            chunk.offsets[i] = clock;
+            chunk.services[i] = (float)ServiceTime(state);
+        }
+    }
+
+    // SERVICE TIME
+    // Draws a service time from the configured distribution
+    double ServiceTime(uint64_t* state) const {
+        switch (config.service) {
+            case Generator_Config::SRV_PARETO:
+                return paretoScale / pow(1.0 - Uniform(state), 1.0 / config.alpha);
+
+            case Generator_Config::SRV_BIMODAL:
+                return (Uniform(state) < config.longFraction) ? config.longService
+                                                              : config.shortService;
+
+            case Generator_Config::SRV_EXPONENTIAL:
+            default:
+                return Exponential(state, config.meanService);
+        }
+    }
+
+    // EXPONENTIAL
+    // Draws an exponentially distributed value with the given mean
+    static double Exponential(uint64_t* state, double mean) {
+        return -mean * log1p(-Uniform(state));
+    }
+
+    // UNIFORM
+    // Draws a uniformly distributed value in [0, 1)
+    static double Uniform(uint64_t* state) {
+        return (double)(Next(state) >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // NEXT
+    // Advances a xoshiro256** state and returns 64 random bits
+    static uint64_t Next(uint64_t* s) {
+        uint64_t result = Rotate(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = Rotate(s[3], 45);
+        return result;
+    }
+
+    // ROTATE
+    // Rotates "x" left by "k" bits
+    static uint64_t Rotate(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    // SPLIT MIX
+    // Advances a splitmix64 state and returns 64 random bits (seeds xoshiro)
+    static uint64_t SplitMix(uint64_t& x) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+};
+
+#endif // RR_GENERATOR_MODULE_H_
@@ -0,0 +1,220 @@
+#ifndef RR_JOBTABLE_MODULE_H_
+#define RR_JOBTABLE_MODULE_H_
+
+#include <vector>
+#include <stdint.h>
+using namespace std;
+
+#include "rr-pcb-module.h"
+
+// The state of every process in the system, kept as columns (structure of arrays)
+// instead of one PCB object per process. A job is its 32-bit slot in the table,
+// which is what queues and the CPU hold. The columns touched by every time slice
+// (the time left and the state: 5 bytes per job) live apart from the ones only read
+// when a job is dispatched for the first time or retires (process ID, arrival,
+// service and start times: 16 bytes per job), so a run with millions of live jobs
+// streams through dense hot columns. The columns grow in slabs that are never
+// moved and are kept across Reset(); released slots are handed out again first, so
+// the table only grows to the number of processes that are live at the same time.
+// A job's end time is not kept: it is the CPU clock the moment the job retires.
+class JobTable_Module {
+public:
+    static const uint32_t NO_JOB = 0xFFFFFFFFu;    // "no job" (e.g. an idle CPU)
+
+private:
+    static const unsigned int SLAB_BITS = 12;
+    static const size_t SLAB_SIZE = (size_t)1 << SLAB_BITS;    // jobs per slab
+
+    // the hot columns of SLAB_SIZE jobs
+    struct HotSlab {
+        float timeLeft[SLAB_SIZE];      // time left after one or more executions
+        uint8_t state[SLAB_SIZE];       // PCB_Module::ProcessState_t
+    };
+
+    // the cold columns of SLAB_SIZE jobs
+    struct ColdSlab {
+        uint32_t processId[SLAB_SIZE];  // process ID
+        float arrivalTime[SLAB_SIZE];   // arrival time [CPU clock]
+        float serviceTime[SLAB_SIZE];   // amount of time the process needs to execute
+        double startTime[SLAB_SIZE];    // time the process started executing [CPU clock]
+    };
+
+    vector<HotSlab*> hot;                   // the hot slabs
+    vector<ColdSlab*> cold;                 // the cold slabs (same count)
+    size_t used;                            // slots handed out since the last reset
+    vector<uint32_t> released;              // released slots, handed out again first
+
+    // snapshots save and restore the handed out slots (see Checkpoint_Module)
+    friend class Checkpoint_Module;
+
+    // the slabs are owned, so a table is never copied
+    JobTable_Module(const JobTable_Module&) = delete;
+    JobTable_Module& operator=(const JobTable_Module&) = delete;
+
+public:
+    // CONSTRUCTOR - JOB TABLE MODULE
+    JobTable_Module() {
+        used = 0;
+    }
+
+    // DE-CONSTRUCTOR - JOB TABLE MODULE
+    ~JobTable_Module() {
+        for (size_t i = 0; i < hot.size(); i++) {
+            delete hot[i];
+            delete cold[i];
+        }
+    }
+
+    // RESERVE
+    // Makes sure "count" jobs can be handed out without allocating
+    void Reserve(size_t count) {
+        while (hot.size() * SLAB_SIZE < count) {
+            hot.push_back(new HotSlab);
+            cold.push_back(new ColdSlab);
+        }
+    }
+
+    // ALLOCATE
+    // Adds a new (not yet submitted) job to the table and returns its slot
+    uint32_t Allocate(unsigned int ID, float arrTime, float servTime) {
+        uint32_t job = Slot();
+        Place(job, ID, arrTime, servTime);
+        return job;
+    }
+
+    // ADOPT
+    // Moves job "job" of table "from" (another CPU's) into this table and returns
+    // its slot here
+    uint32_t Adopt(JobTable_Module& from, uint32_t job) {
+        uint32_t slot = Slot();
+        Restore(slot, from.GetProcessId(job), from.GetArrivalTime(job),
+                from.GetServiceTime(job), from.GetTimeRemaining(job),
+                from.BeganExecution(job), from.GetProcessState(job));
+        from.Release(job);
+        return slot;
+    }
+
+    // RELEASE
+    // Gives a job's slot back to the table (for a process that has left the system)
+    void Release(uint32_t job) {
+        released.push_back(job);
+    }
+
+    // RESET
+    // Releases every job in one shot; the slabs are kept for the next run
+    void Reset() {
+        used = 0;
+        released.clear();
+    }
+
+    // USED
+    // Returns the number of jobs that are currently in the table
+    size_t Used() const {
+        return used - released.size();
+    }
+
+    // CAPACITY
+    // Returns the number of jobs that fit in the slabs
+    size_t Capacity() const {
+        return hot.size() * SLAB_SIZE;
+    }
+
+    // GET TIME REMAINING
+    // Returns the amount of time remaining to service job "job"
+    float GetTimeRemaining(uint32_t job) const {
+        return hot[job >> SLAB_BITS]->timeLeft[job & (SLAB_SIZE - 1)];
+    }
+
+    // FIRE
+    // Decreases a job's time left by amount and returns the time left
+    float Fire(uint32_t job, float amount) {
+        float& timeLeft = hot[job >> SLAB_BITS]->timeLeft[job & (SLAB_SIZE - 1)];
+        timeLeft -= amount;
+        return timeLeft;
+    }
+
+    // GET PROCESS STATE
+    // Returns a job's current state
+    PCB_Module::ProcessState_t GetProcessState(uint32_t job) const {
+        uint8_t state = hot[job >> SLAB_BITS]->state[job & (SLAB_SIZE - 1)];
+        return (PCB_Module::ProcessState_t)state;
+    }
+
+    // CHANGE STATE
+    // Changes a job's state; the first time it runs, the CPU time is logged as its
+    // start time (used for waiting time), exactly as PCB_Module::ChangeState does
+    void ChangeState(uint32_t job, PCB_Module::ProcessState_t newState, double cpuTime) {
+        HotSlab& h = *hot[job >> SLAB_BITS];
+        const size_t i = job & (SLAB_SIZE - 1);
+        h.state[i] = (uint8_t)newState;
+        if (newState == PCB_Module::PS_RUNNING) {
+            ColdSlab& c = *cold[job >> SLAB_BITS];
+            if (h.timeLeft[i] == c.serviceTime[i])
+                c.startTime[i] = cpuTime;
+        }
+    }
+
+    // GET PROCESS ID
+    // Returns a job's process ID
+    unsigned int GetProcessId(uint32_t job) const {
+        return cold[job >> SLAB_BITS]->processId[job & (SLAB_SIZE - 1)];
+    }
+
+    // GET ARRIVAL TIME
+    // Returns a job's arrival time
+    float GetArrivalTime(uint32_t job) const {
+        return cold[job >> SLAB_BITS]->arrivalTime[job & (SLAB_SIZE - 1)];
+    }
+
+    // GET SERVICE TIME
+    // Returns the amount of time needed to service a job
+    float GetServiceTime(uint32_t job) const {
+        return cold[job >> SLAB_BITS]->serviceTime[job & (SLAB_SIZE - 1)];
+    }
+
+    // BEGAN EXECUTION
+    // Returns the (cpu) time a job began executing
+    double BeganExecution(uint32_t job) const {
+        return cold[job >> SLAB_BITS]->startTime[job & (SLAB_SIZE - 1)];
+    }
+
+private:
+    // SLOT
+    // Hands out a free slot (a released one first), growing the slabs if needed
+    uint32_t Slot() {
+        if (!released.empty()) {
+            uint32_t job = released.back();
+            released.pop_back();
+            return job;
+        }
+        if (used == hot.size() * SLAB_SIZE)
+            Reserve(used + 1);
+        return (uint32_t)used++;
+    }
+
+    // PLACE
+    // Initializes slot "job" for a new process (as the PCB_Module constructor does)
+    void Place(uint32_t job, unsigned int ID, float arrTime, float servTime) {
+        HotSlab& h = *hot[job >> SLAB_BITS];
+        ColdSlab& c = *cold[job >> SLAB_BITS];
+        const size_t i = job & (SLAB_SIZE - 1);
+        h.timeLeft[i] = servTime;
+        h.state[i] = (uint8_t)PCB_Module::PS_NULL;
+        c.processId[i] = ID;
+        c.arrivalTime[i] = arrTime;
+        c.serviceTime[i] = servTime;
+        c.startTime[i] = 0.0;
+    }
+
+    // RESTORE
+    // Puts slot "job" back in a saved state (see Checkpoint_Module)
+    void Restore(uint32_t job, unsigned int ID, float arrTime, float servTime,
+                    float timeLeft, double startTime, PCB_Module::ProcessState_t state) {
+        Place(job, ID, arrTime, servTime);
+        hot[job >> SLAB_BITS]->timeLeft[job & (SLAB_SIZE - 1)] = timeLeft;
+        hot[job >> SLAB_BITS]->state[job & (SLAB_SIZE - 1)] = (uint8_t)state;
+        cold[job >> SLAB_BITS]->startTime[job & (SLAB_SIZE - 1)] = startTime;
+    }
+};
+
+#endif // RR_JOBTABLE_MODULE_H_
@@ -0,0 +1,665 @@
+// The round robin simulator: runs every (time quantum x overhead) cell of the sweep
+// over a process list and writes the analysis and excel output files.
+//
+//     rr-simulator [-j N | --threads=N] [--step] [--stream] [--engine]
+//                  [--timeline=DIR] [--analysis=FILE] [--excel=FILE]
+//                  [--results=FILE] [--results-format=csv|jsonl|bin]
+//                  [--checkpoint=DIR [--checkpoint-interval=SECS]] [--branch-from=FILE]
+//                  [--follow [--follow-interval=SECS] [--follow-idle=SECS]]
+//                  [--processes=N] [--split] [--cpus=N [--balance-interval=SECS]]
+//                  [--cache=FILE]
+//                  [--optimize=OBJECTIVE [--tq-range=MIN,MAX] [--tq-tolerance=REL]]
+//                  [--generate=SPEC | process-list]
+//
+// --generate simulates a synthetic workload instead of a process list; SPEC is a
+// comma separated key=value list (see Generator_Config::Parse), e.g.
+// "jobs=1e8,arrivals=onoff,service=pareto,alpha=1.5,util=0.95,seed=7".
+// --timeline writes every event of simulation #N to DIR/timeline-N.rrtl (see
+// rr-timeline-decode for viewing them).
+// --analysis and --excel move the text output files (../output/analysis-output.txt
+// and ../output/excel-output.txt by default); --results also writes every
+// simulation's results as CSV, JSON lines or a binary columnar file (see
+// Results_Module; the format follows the file's extension unless it is given).
+// --checkpoint saves the state of simulation #N to DIR/snapshot-N.rrsnap every SECS
+// seconds (60 by default) and when it finishes; running the same command again
+// resumes every simulation from its snapshot (see Checkpoint_Module).
+// --branch-from starts every simulation from a snapshot taken on the same process
+// list (with the simulation's own time quantum and overhead) instead of from time 0.
+// --follow keeps reading the (text) process list as it grows: every SECS seconds (1
+// by default) the processes appended to it are read, every simulation continues
+// from where it stopped and the output files are rewritten with the updated
+// results. It stops on SIGINT or SIGTERM, or once the file has not grown for
+// --follow-idle seconds, and then finishes every simulation (giving the results a
+// run over the whole file gives).
+// --processes runs the simulations in N worker processes (forked once the process
+// list is loaded) instead of threads; a simulation whose worker dies is run again
+// by another one (see Shard_Module).
+// --split runs the simulations one after the other, each one cut at the idle
+// periods of the process list into segments that run on all the threads at once
+// (see Split_Module); the results are those of the ordinary runs.
+// --cpus simulates a system of N CPUs, each with its own ready queue: arriving
+// processes go to the least loaded CPU and an idle CPU steals half of the longest
+// ready queue. The CPUs are simulated in parallel on the threads, one window of
+// SECS simulated seconds (10 time quanta by default) at a time, and the load is
+// balanced between windows (see Multicore_Module).
+// --cache keeps the results of every simulation in FILE, addressed by the contents
+// of the process list, the simulator version and the simulation's settings: a
+// simulation found there is not run again (see Cache_Module).
+// --optimize searches, for every overhead, the time quantum between MIN and MAX
+// seconds (0.01 and 1 by default) that minimizes OBJECTIVE (avg-wait,
+// avg-turnaround or p99-turnaround) instead of simulating the fixed time quanta,
+// to within REL (1% by default); the output has the best simulation of every
+// overhead (see Optimizer_Module).
+
+#include <csignal>
+#include <chrono>
+#include <atomic>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "rr-simulator.h"
+
+bool write_results(Results_Module*, const string&);
+bool write_outputs(const Sweep_Module&, const string&, const string&);
+bool follow_input(Sweep_Module&, const char*, bool, double, double, const int,
+                    const string&, const string&, Results_Module*, const string&);
+void optimize(Optimizer_Module&, const Workload_Module&, const float*, int, bool,
+                ostream&, ostream&, Results_Module*);
+void stop_following(int);
+bool writable_dir(const char*);
+
+// set by SIGINT/SIGTERM to end --follow
+volatile sig_atomic_t followStopped = 0;
+
+int main(int argc, char** argv) {
+    const char* infile = NULL;
+    unsigned int threads = 0;
+    bool fastForward = true;
+    bool stream = false;
+    bool engine = false;
+    bool generate = false;
+    Generator_Config synthetic;
+    const char* timelineDir = NULL;
+    string analysisFile = "../output/analysis-output.txt";
+    string excelFile = "../output/excel-output.txt";
+    string resultsFile, resultsFormat;
+    const char* checkpointDir = NULL;
+    double checkpointInterval = 60.0;
+    const char* branchFrom = NULL;
+    bool follow = false;
+    double followInterval = 1.0;
+    double followIdle = 0.0;
+    unsigned int processes = 0;
+    bool split = false;
+    unsigned int cpus = 0;
+    float balanceInterval = 0.0f;
+    const char* cacheFile = NULL;
+    bool optimizing = false;
+    Optimizer_Module::Objective_t objective = Optimizer_Module::OBJ_AVG_WAIT;
+    float tqMin = 0.01f, tqMax = 1.0f;
+    double tqTolerance = 0.01;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            threads = (unsigned int)atoi(argv[++i]);
+        } else if (arg.compare(0, 10, "--threads=") == 0) {
+            threads = (unsigned int)atoi(arg.c_str() + 10);
+        } else if (arg == "--step") {
+            // execute every quantum one by one (no fast forwarding)
+            fastForward = false;
+        } else if (arg == "--stream") {
+            // read the input while simulating instead of loading it up front
+            stream = true;
+        } else if (arg == "--engine") {
+            // use the compile-time specialized engine (see Engine_Module)
+            engine = true;
+        } else if (arg.compare(0, 11, "--generate=") == 0) {
+            // generate a synthetic workload (see Generator_Module)
+            generate = true;
+            if (!synthetic.Parse(arg.substr(11))) {
+                cerr << "Malformed workload description " << arg << "\n";
+                exit (EXIT_FAILURE);
+            }
+        } else if (arg.compare(0, 11, "--timeline=") == 0) {
+            // record every event of every simulation (see Timeline_Module)
+            timelineDir = argv[i] + 11;
+        } else if (arg.compare(0, 11, "--analysis=") == 0) {
+            analysisFile = arg.substr(11);
+        } else if (arg.compare(0, 8, "--excel=") == 0) {
+            excelFile = arg.substr(8);
+        } else if (arg.compare(0, 10, "--results=") == 0) {
+            // write structured results (see Results_Module)
+            resultsFile = arg.substr(10);
+        } else if (arg.compare(0, 17, "--results-format=") == 0) {
+            resultsFormat = arg.substr(17);
+        } else if (arg.compare(0, 13, "--checkpoint=") == 0) {
+            // save (and resume from) snapshots of every simulation
+            checkpointDir = argv[i] + 13;
+        } else if (arg.compare(0, 22, "--checkpoint-interval=") == 0) {
+            checkpointInterval = atof(arg.c_str() + 22);
+        } else if (arg == "--follow") {
+            // keep simulating the process list as it grows (see Tail_Module)
+            follow = true;
+        } else if (arg.compare(0, 18, "--follow-interval=") == 0) {
+            followInterval = atof(arg.c_str() + 18);
+        } else if (arg.compare(0, 14, "--follow-idle=") == 0) {
+            followIdle = atof(arg.c_str() + 14);
+        } else if (arg.compare(0, 12, "--processes=") == 0) {
+            // spread the simulations across worker processes
+            processes = (unsigned int)atoi(arg.c_str() + 12);
+        } else if (arg == "--split") {
+            // spread every simulation across the threads (see Split_Module)
+            split = true;
+        } else if (arg.compare(0, 7, "--cpus=") == 0) {
+            // simulate several CPUs (see Multicore_Module)
+            cpus = (unsigned int)atoi(arg.c_str() + 7);
+        } else if (arg.compare(0, 19, "--balance-interval=") == 0) {
+            balanceInterval = (float)atof(arg.c_str() + 19);
+        } else if (arg.compare(0, 11, "--optimize=") == 0) {
+            // search the best time quantum (see Optimizer_Module)
+            optimizing = true;
+            if (!Optimizer_Module::ParseObjective(arg.substr(11), objective)) {
+                cerr << "Unknown objective " << arg.substr(11) << "\n";
+                exit (EXIT_FAILURE);
+            }
+        } else if (arg.compare(0, 11, "--tq-range=") == 0) {
+            if (sscanf(arg.c_str() + 11, "%f,%f", &tqMin, &tqMax) != 2 ||
+                    !(tqMin > 0.0f) || !(tqMax > tqMin)) {
+                cerr << "Malformed time quantum range " << arg << "\n";
+                exit (EXIT_FAILURE);
+            }
+        } else if (arg.compare(0, 15, "--tq-tolerance=") == 0) {
+            tqTolerance = atof(arg.c_str() + 15);
+            if (!(tqTolerance > 0.0)) {
+                cerr << "The time quantum tolerance must be positive\n";
+                exit (EXIT_FAILURE);
+            }
+        } else if (arg.compare(0, 8, "--cache=") == 0) {
+            // reuse the results of earlier sweeps (see Cache_Module)
+            cacheFile = argv[i] + 8;
+        } else if (arg.compare(0, 14, "--branch-from=") == 0) {
+            // start every simulation from a saved snapshot
+            branchFrom = argv[i] + 14;
+        } else if (infile == NULL) {
+            infile = argv[i];
+        } else {
+            cerr << "Too many arguments... Continuing.\n";
+        }
+    }
+    if (infile == NULL)
+        infile = "../input/process-list.txt";
+    
+    // list of overheads and time quantum (in seconds)
+    const int NUMB_OF_OVERHEADS = 6;
+    const int NUMB_OF_TQS = NUMB_OF_SWEEP_TQS;
+    const int NUMB_OF_RUNS = NUMB_OF_OVERHEADS + NUMB_OF_TQS;
+    float overheads[NUMB_OF_OVERHEADS] = { 0.0f, 0.005f, 0.01f, 0.015f, 0.02f, 0.025f };
+    float time_quantums[NUMB_OF_TQS];
+    for (int i = 0; i < NUMB_OF_TQS; i++)
+        time_quantums[i] = (float)SWEEP_TQ_MICROSECONDS[i] / 1000000.0f;
+    
+    // open output files
+    ofstream excel_out(excelFile.c_str());
+    ofstream analysis_out(analysisFile.c_str());
+    // check if the output files are open
+    if (!excel_out.good() || !analysis_out.good()) {
+        cerr << "One of the output files cannot open!\nExiting...\n";
+        exit (EXIT_FAILURE);
+    }
+    // the structured results are collected in memory and written once at the end
+    // (the file is created now so a bad path fails before the simulations run)
+    Results_Module* results = NULL;
+    if (!resultsFile.empty()) {
+        if (resultsFormat.empty())
+            resultsFormat = Results_Module::FormatFor(resultsFile);
+        results = Results_Module::Create(resultsFormat);
+        if (results == NULL) {
+            cerr << "Unknown results format " << resultsFormat << "\nExiting...\n";
+            exit (EXIT_FAILURE);
+        }
+        if (!ofstream(resultsFile.c_str()).good()) {
+            cerr << "The results file cannot open!\nExiting...\n";
+            exit (EXIT_FAILURE);
+        }
+    }
+    // ==== initialization ==== //
+    // the process list is parsed (or generated) once and shared (read-only) by every
+    // simulation, unless it is streamed (read or generated by every simulation as it
+    // runs)
+    Workload_Module workload;
+    if (follow && (engine || generate || timelineDir != NULL ||
+                    checkpointDir != NULL || branchFrom != NULL)) {
+        cerr << "--follow runs the reference simulator on a growing process list; "
+                "ignoring --engine, --generate, --timeline, --checkpoint "
+                "and --branch-from.\n";
+        engine = generate = false;
+        timelineDir = checkpointDir = branchFrom = NULL;
+    }
+    if (timelineDir != NULL && engine) {
+        cerr << "Timelines are only recorded by the reference simulator; "
+                "ignoring --timeline.\n";
+        timelineDir = NULL;
+    }
+    if ((checkpointDir != NULL || branchFrom != NULL) && (engine || stream)) {
+        cerr << "Snapshots are only taken of the reference simulator replaying a loaded "
+                "process list; ignoring --checkpoint and --branch-from.\n";
+        checkpointDir = NULL;
+        branchFrom = NULL;
+    }
+    if (processes > 0 && follow) {
+        cerr << "--follow runs in this process; ignoring --processes.\n";
+        processes = 0;
+    }
+    if (split && (stream || engine || follow || timelineDir != NULL ||
+                    checkpointDir != NULL || branchFrom != NULL || processes > 0)) {
+        cerr << "--split runs the reference simulator on a loaded process list, one "
+                "simulation at a time; ignoring --split.\n";
+        split = false;
+    }
+    if (cpus > 0 && (stream || engine || follow || timelineDir != NULL ||
+                    checkpointDir != NULL || branchFrom != NULL || processes > 0 ||
+                    split)) {
+        cerr << "--cpus runs the reference simulator on a loaded process list, one "
+                "simulation at a time; ignoring --cpus.\n";
+        cpus = 0;
+    }
+    if (optimizing && (stream || engine || follow || timelineDir != NULL ||
+                        checkpointDir != NULL || branchFrom != NULL || processes > 0 ||
+                        split || cpus > 0)) {
+        cerr << "--optimize runs the reference simulator on a loaded process list; "
+                "ignoring --optimize.\n";
+        optimizing = false;
+    }
+    if (cacheFile != NULL && (stream || follow || timelineDir != NULL ||
+                                branchFrom != NULL || optimizing)) {
+        cerr << "Only simulations of a whole loaded process list from time 0 are "
+                "cached; ignoring --cache.\n";
+        cacheFile = NULL;
+    }
+    // performs all of the experiments by spreading the (time quantum x overhead) grid
+    // across the sweep's workers; every cell buffers its own output
+    // (split and multi-CPU simulations take the threads one simulation at a time)
+    Sweep_Module sweep(time_quantums, NUMB_OF_TQS, overheads, NUMB_OF_OVERHEADS,
+                        (split || cpus > 0) ? 1 : threads);
+    // streamed generators share the cores with the sweep's workers
+    unsigned int cores = thread::hardware_concurrency();
+    unsigned int generatorThreads = (cores > sweep.Workers()) ? cores / sweep.Workers() : 1;
+    if (follow) {
+        // the output files are rewritten after every round
+        excel_out.close();
+        analysis_out.close();
+        bool done = follow_input(sweep, infile, fastForward, followInterval, followIdle,
+                                    NUMB_OF_RUNS, analysisFile, excelFile, results,
+                                    resultsFile);
+        delete results;
+        return done ? 0 : EXIT_FAILURE;
+    }
+    if (!stream && generate) {
+        Generator_Module generator(synthetic);
+        generator.Fill(workload);
+    } else if (!stream) {
+        Sim_Status_t status = readfile(workload, infile);
+        if (status != SS_OK) {
+            cerr << "Could not read " << infile << ": " << StatusMessage(status);
+            if (status == SS_UNREADABLE_INPUT && !workload.Error().empty())
+                cerr << " (" << workload.Error() << ")";
+            else if (status == SS_BAD_WORKLOAD)
+                cerr << " (process #" << workload.FirstInvalid() + 1 << " is not)";
+            cerr << "\nExiting...\n";
+            exit (EXIT_FAILURE);
+        }
+    }
+    // the workload's hash keys the cache and ties snapshots to the workload; it
+    // reads the whole process list, so it is computed once
+    bool hashed = (cacheFile != NULL || checkpointDir != NULL || branchFrom != NULL);
+    uint64_t trace = hashed ? workload.Hash() : 0;
+    if (branchFrom != NULL) {
+        Simulation_Module probe;
+        if (!Checkpoint_Module::Restore(probe, workload, trace, branchFrom)) {
+            cerr << "Could not branch from " << branchFrom << "\nExiting...\n";
+            exit (EXIT_FAILURE);
+        }
+    }
+    // a snapshot or timeline directory that cannot be written to would fail every
+    // simulation
+    if (checkpointDir != NULL && !writable_dir(checkpointDir)) {
+        cerr << "Cannot write snapshots to " << checkpointDir << "\nExiting...\n";
+        exit (EXIT_FAILURE);
+    }
+    if (timelineDir != NULL && !writable_dir(timelineDir)) {
+        cerr << "Cannot write timelines to " << timelineDir << "\nExiting...\n";
+        exit (EXIT_FAILURE);
+    }
+    if (optimizing) {
+        if (workload.Size() == 0) {
+            cerr << "There are no processes to optimize for.\nExiting...\n";
+            exit (EXIT_FAILURE);
+        }
+        Optimizer_Module optimizer(objective, tqMin, tqMax, tqTolerance, threads);
+        optimize(optimizer, workload, overheads, NUMB_OF_OVERHEADS, fastForward,
+                    analysis_out, excel_out, results);
+        excel_out.close();
+        analysis_out.close();
+        return write_results(results, resultsFile) ? 0 : EXIT_FAILURE;
+    }
+    // every worker owns one simulation run (queues, CPU, scheduler, job table) and
+    // resets it for each cell it picks up
+    vector<Simulation_Module*> runs;
+    for (unsigned int i = 0; i < sweep.Workers(); i++)
+        runs.push_back(new Simulation_Module);
+    Split_Module* splitter = split ? new Split_Module(threads) : NULL;
+    Multicore_Module* multicore = (cpus > 0) ? new Multicore_Module(cpus, threads,
+                                                        balanceInterval) : NULL;
+    // the simulations already in the cache are not run again
+    Cache_Module* cache = (cacheFile != NULL) ? new Cache_Module(cacheFile) : NULL;
+    atomic<int> cacheHits(0);
+    atomic<bool> snapshotsLost(false);
+    atomic<bool> timelinesLost(false);
+    atomic<bool> inputLost(false);
+    Sweep_Module::CellTask_t simulate = [&](Sweep_Cell& cell, int worker) {
+        cell.analysis << "START SIMULATION #" << cell.count << "\n";
+        Cache_Key key = Cache_Module::KeyFor(trace, cell.timeQuantum, cell.overhead,
+                                                cpus, (cpus > 0) ? balanceInterval : 0.0f);
+        Result_Row row;
+        if (cache != NULL && cache->Find(key, row)) {
+            row.values[Result_Row::RC_SIMULATION] = cell.count;
+            perform_analysis(row, cell.analysis, cell.excel);
+            if (results != NULL)
+                results->Add(row);
+            cell.analysis << "END SIMULATION [#" << cell.count << "]\n\n\n";
+            cacheHits++;
+            return;
+        }
+        Profile_Module::Reset();
+        Simulation_Module* run = runs[worker];
+        run->Reset(cell.timeQuantum, cell.overhead);
+        Timeline_Module* timeline = NULL;
+        string timelineFile;
+        if (timelineDir != NULL) {
+            timelineFile = string(timelineDir) + "/timeline-" +
+                            to_string(cell.count) + ".rrtl";
+            timeline = new Timeline_Module(timelineFile.c_str(), cell.timeQuantum,
+                                            cell.overhead);
+            run->SetTimeline(timeline);
+        }
+        // ==== initialization & simulation ==== //
+        Run_Metrics metrics;
+        if (stream) {
+            StreamSource_Module* file = NULL;
+            Source_Module* source;
+            if (generate)
+                source = new Generator_Module(synthetic, generatorThreads);
+            else
+                source = file = new StreamSource_Module(infile);
+            if (engine) {
+                metrics = run_engine(*source, cell.timeQuantum, cell.overhead,
+                                        run->Stats());
+            } else {
+                run->Load(*source);
+                run_simulator(run->Scheduler(), run->Cpu(), run->Events(), fastForward);
+                metrics = run->Metrics();
+            }
+            Sim_Status_t status = (file != NULL) ? file->Status() : SS_OK;
+            if (status != SS_OK) {
+                cell.analysis << "(input could not be read completely)\n";
+                // every cell reads the file, so the reason is reported once
+                if (!inputLost.exchange(true))
+                    cerr << "Could not read " << infile << ": " << StatusMessage(status)
+                         << " (" << file->Error() << ")\n";
+            }
+            delete source;
+        } else if (splitter != NULL) {
+            metrics = run_split(*splitter, workload, cell.timeQuantum, cell.overhead,
+                                run->Stats(), fastForward);
+        } else if (multicore != NULL) {
+            metrics = run_multicore(*multicore, workload, cell.timeQuantum, cell.overhead,
+                                    run->Stats(), fastForward);
+        } else if (engine) {
+            WorkloadSource_Module source(&workload);
+            metrics = run_engine(source, cell.timeQuantum, cell.overhead, run->Stats());
+        } else {
+            // resume the cell from its own snapshot, or branch it off the shared one
+            Checkpoint_Module* checkpoint = NULL;
+            bool restored = false;
+            if (checkpointDir != NULL) {
+                string snapshotFile = string(checkpointDir) + "/snapshot-" +
+                                        to_string(cell.count) + ".rrsnap";
+                restored = Checkpoint_Module::Restore(*run, workload, trace,
+                                                        snapshotFile.c_str());
+                if (restored && (run->Cpu().GetTimeQuantum() != cell.timeQuantum ||
+                                 run->Scheduler()->GetOverhead() != cell.overhead)) {
+                    cerr << snapshotFile << " belongs to another simulation; "
+                            "starting over\n";
+                    run->Reset(cell.timeQuantum, cell.overhead);
+                    restored = false;
+                } else if (restored) {
+                    cerr << "Simulation #" << cell.count << " resumed from "
+                         << snapshotFile << "\n";
+                }
+                checkpoint = new Checkpoint_Module(run, trace, snapshotFile,
+                                                    checkpointInterval);
+            }
+            if (!restored && branchFrom != NULL &&
+                    Checkpoint_Module::Restore(*run, workload, trace, branchFrom)) {
+                run->Retune(cell.timeQuantum, cell.overhead);
+                restored = true;
+            }
+            if (!restored)
+                run->Load(workload);
+            run_simulator(run->Scheduler(), run->Cpu(), run->Events(),
+                            fastForward, checkpoint);
+            if (checkpoint != NULL) {
+                // the finished run is saved too, so a restarted sweep skips it
+                if (!checkpoint->SaveNow())
+                    snapshotsLost = true;
+                delete checkpoint;
+            }
+            metrics = run->Metrics();
+        }
+        if (timeline != NULL) {
+            run->SetTimeline(NULL);
+            if (!timeline->Close()) {
+                cerr << "Could not write timeline " << timelineFile << "\n";
+                timelinesLost = true;
+            }
+            delete timeline;
+        }
+        // ==== do analysis ==== //
+        row = Result_Row::From(metrics, cell.count);
+        perform_analysis(row, cell.analysis, cell.excel);
+        if (results != NULL)
+            results->Add(row);
+        cell.simulated = true;
+        cell.row = row;
+        Profile_Module::Report(cell.analysis);
+        cell.analysis << "END SIMULATION [#" << cell.count << "]\n\n\n";
+    };
+    // the simulations run on the sweep's threads or on worker processes
+    bool simulated = true;
+    if (processes > 0) {
+        Shard_Module shard(processes);
+        simulated = shard.Run(sweep, simulate, results);
+    } else {
+        sweep.Run(simulate);
+    }
+    for (size_t i = 0; i < runs.size(); i++)
+        delete runs[i];
+    delete splitter;
+    delete multicore;
+    // (the hits of worker processes are not counted here)
+    if (cache != NULL && processes == 0)
+        cerr << cacheHits << " of " << sweep.Cells() << " simulations were found in "
+             << cacheFile << "\n";
+    // the new simulations go into the cache in one go
+    if (cache != NULL) {
+        for (int i = 0; i < sweep.Cells(); i++) {
+            Sweep_Cell& cell = sweep.Cell(i);
+            if (cell.simulated)
+                cache->Add(Cache_Module::KeyFor(trace, cell.timeQuantum, cell.overhead,
+                                cpus, (cpus > 0) ? balanceInterval : 0.0f), cell.row);
+        }
+        if (!cache->Store())
+            cerr << "Could not add the new simulations to " << cacheFile << "\n";
+    }
+    delete cache;
+    // write the results in grid order once every simulation has finished
+    sweep.Merge(analysis_out, excel_out);
+    excel_out.close();
+    analysis_out.close();
+    bool written = write_results(results, resultsFile);
+    bool complete = written && simulated && !snapshotsLost && !timelinesLost &&
+                    !inputLost;
+    return complete ? 0 : EXIT_FAILURE;
+}
+
+// WRITE RESULTS
+// Writes (and deletes) the structured results, if any were collected
+bool write_results(Results_Module* results, const string& fileStr) {
+    if (results == NULL)
+        return true;
+    bool written = results->Write(fileStr.c_str());
+    if (!written)
+        cerr << "Could not write " << fileStr << "\n";
+    delete results;
+    return written;
+}
+
+// FOLLOW INPUT
+// Follows "infile" as it grows. Every simulation of the sweep keeps its own run;
+// whenever processes have been appended to the file, every run continues from
+// where it stopped up to the new horizon (so the work done is proportional to the
+// new processes) and the output files are rewritten with every simulation's
+// results so far. Once following stops (a signal, "idle" seconds without growth
+// or a malformed file), the runs are finished and the final results written.
+bool follow_input(Sweep_Module& sweep, const char* infile, bool fastForward,
+                    double interval, double idle, const int MAX,
+                    const string& analysisFile, const string& excelFile,
+                    Results_Module* results, const string& resultsFile) {
+    Tail_Module tail(infile);
+    vector<Simulation_Module*> runs;
+    vector<TailSource_Module*> sources;
+    for (int i = 0; i < sweep.Cells(); i++) {
+        runs.push_back(new Simulation_Module);
+        sources.push_back(new TailSource_Module(&tail));
+    }
+    signal(SIGINT, stop_following);
+    signal(SIGTERM, stop_following);
+    chrono::steady_clock::time_point grew = chrono::steady_clock::now();
+    bool written = true;
+    for (int round = 0; ; round++) {
+        // ==== read what was appended ==== //
+        chrono::duration<double> quiet = chrono::steady_clock::now() - grew;
+        bool closing = followStopped || tail.Failed() ||
+                        (idle > 0.0 && quiet.count() >= idle);
+        if (closing)
+            tail.Close();
+        else if (tail.Poll() > 0)
+            grew = chrono::steady_clock::now();
+        else if (round > 0) {
+            this_thread::sleep_for(chrono::duration<double>(interval));
+            continue;
+        }
+        // ==== continue every simulation ==== //
+        sweep.Clear();
+        if (results != NULL)
+            results->Clear();
+        sweep.Run([&](Sweep_Cell& cell, int) {
+            Simulation_Module* run = runs[cell.count - 1];
+            if (round == 0) {
+                run->Reset(cell.timeQuantum, cell.overhead);
+                run->Load(*sources[cell.count - 1]);
+            }
+            run_simulator(run->Scheduler(), run->Cpu(), run->Events(), fastForward);
+            Run_Metrics metrics = run->Metrics();
+            cell.analysis << "START SIMULATION #" << cell.count << "\n";
+            perform_analysis(metrics, cell.count, MAX, cell.analysis, cell.excel);
+            cell.analysis << "END SIMULATION [#" << cell.count << "]\n\n\n";
+            if (results != NULL)
+                results->Add(metrics, cell.count);
+        });
+        // the processes every run has admitted are not needed anymore
+        uint64_t oldest = tail.End();
+        for (size_t i = 0; i < sources.size(); i++)
+            oldest = min(oldest, sources[i]->Position());
+        tail.Trim(oldest);
+        // ==== emit the results so far ==== //
+        written = write_outputs(sweep, analysisFile, excelFile);
+        if (results != NULL && !results->Write(resultsFile.c_str())) {
+            cerr << "Could not write " << resultsFile << "\n";
+            written = false;
+        }
+        if (closing)
+            break;
+        this_thread::sleep_for(chrono::duration<double>(interval));
+    }
+    for (size_t i = 0; i < runs.size(); i++) {
+        delete runs[i];
+        delete sources[i];
+    }
+    return written && !tail.Failed();
+}
+
+// WRITE OUTPUTS
+// Replaces the analysis and excel files with the sweep's output (through temporary
+// files, so readers never see a half written file)
+bool write_outputs(const Sweep_Module& sweep, const string& analysisFile,
+                    const string& excelFile) {
+    string analysisTemp = analysisFile + ".tmp", excelTemp = excelFile + ".tmp";
+    ofstream analysis_out(analysisTemp.c_str());
+    ofstream excel_out(excelTemp.c_str());
+    sweep.Merge(analysis_out, excel_out);
+    analysis_out.close();
+    excel_out.close();
+    if (analysis_out.fail() || excel_out.fail() ||
+            rename(analysisTemp.c_str(), analysisFile.c_str()) != 0 ||
+            rename(excelTemp.c_str(), excelFile.c_str()) != 0) {
+        cerr << "Could not write the output files\n";
+        return false;
+    }
+    return true;
+}
+
+// STOP FOLLOWING
+// Signal handler ending --follow (the runs are finished before the program exits)
+void stop_following(int) {
+    followStopped = 1;
+}
+
+// WRITABLE DIR
+// Returns true if "dir" is a directory files can be created in
+bool writable_dir(const char* dir) {
+    struct stat dirStat;
+    return (stat(dir, &dirStat) == 0 && S_ISDIR(dirStat.st_mode) &&
+            access(dir, W_OK | X_OK) == 0);
+}
+
+// OPTIMIZE
+// Searches the best time quantum of every overhead and outputs the best simulation
+// of each, numbered by overhead, with the search's figures
+void optimize(Optimizer_Module& optimizer, const Workload_Module& workload,
+                const float* overheads, int count, bool fastForward,
+                ostream& analysis_out, ostream& excel_out, Results_Module* results) {
+    const Optimizer_Module::Objective_t objective = optimizer.GetObjective();
+    vector<Optimizer_Module::Search_Result> searches = optimizer.Run(overheads, count,
+        [&](Simulation_Module* run, float timeQuantum, float overhead, double bound) {
+            return run_bounded(*run, workload, timeQuantum, overhead, objective, bound,
+                                fastForward);
+        });
+    unsigned int simulations = 0, abandoned = 0;
+    for (size_t i = 0; i < searches.size(); i++) {
+        Optimizer_Module::Search_Result& search = searches[i];
+        search.row.values[Result_Row::RC_SIMULATION] = (double)(i + 1);
+        analysis_out << "START OPTIMIZATION #" << i + 1 << "\n";
+        perform_analysis(search.row, analysis_out, excel_out);
+        analysis_out << "\tBest " << Optimizer_Module::ObjectiveName(objective) << " = "
+                     << search.value << " after " << search.simulations
+                     << " simulations (" << search.abandoned << " abandoned early)\n";
+        analysis_out << "END OPTIMIZATION [#" << i + 1 << "]\n\n\n";
+        if (results != NULL)
+            results->Add(search.row);
+        simulations += search.simulations;
+        abandoned += search.abandoned;
+    }
+    cerr << "Optimized " << searches.size() << " overheads with " << simulations
+         << " simulations (" << abandoned << " abandoned early)\n";
+}
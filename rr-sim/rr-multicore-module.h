@@ -0,0 +1,335 @@
+#ifndef RR_MULTICORE_MODULE_H_
+#define RR_MULTICORE_MODULE_H_
+
+#include <vector>
+#include <deque>
+#include <queue>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include <algorithm>
+#include <stdint.h>
+using namespace std;
+
+#include "rr-simulation-module.h"
+#include "rr-threadpool-module.h"
+#include "rr-profile-module.h"
+
+// The processes handed to one core of a multi-CPU system, in arrival order. Only
+// the coordinator adds to it, between windows; only the core's scheduler takes
+// from it, during a window. The pool's barrier separates the two, so the queue
+// needs no lock. The horizon is the end of the current window: everything that
+// arrives before it has been handed out.
+class CoreSource_Module : public Source_Module {
+private:
+    deque<Process_t> processes;     // the processes handed out, not yet arrived
+    float end;                      // the end of the current window
+
+public:
+    // CONSTRUCTOR - CORE SOURCE MODULE
+    CoreSource_Module() {
+        Reset();
+    }
+
+    // RESET
+    // Forgets every process handed out
+    void Reset() {
+        processes.clear();
+        end = 0.0f;
+    }
+
+    // PUSH
+    // Hands a process to the core (in arrival order)
+    void Push(const Process_t& process) {
+        processes.push_back(process);
+    }
+
+    // SET HORIZON
+    // Starts a window that ends at "windowEnd"
+    void SetHorizon(float windowEnd) {
+        end = windowEnd;
+    }
+
+    // PENDING
+    // Returns the number of processes handed out that have not arrived yet
+    size_t Pending() const {
+        return processes.size();
+    }
+
+    // PEEK
+    // Returns the next process to arrive (NULL if none has been handed out)
+    virtual const Process_t* Peek() {
+        return processes.empty() ? NULL : &processes.front();
+    }
+
+    // POP
+    // Consumes the process returned by Peek()
+    virtual void Pop() {
+        processes.pop_front();
+    }
+
+    // HORIZON
+    // Returns the end of the current window
+    virtual float Horizon() {
+        return end;
+    }
+};
+
+// Simulates a system of several CPUs under round robin. Every core is a run of its
+// own (CPU, ready queue, scheduler, job table and statistics) and the cores advance
+// in windows of simulated time. Within a window the cores do not interact, so they
+// are simulated in parallel on host threads and each pauses at the window's end
+// (the horizon of its arrivals). Between windows the coordinator balances the load:
+//   1. an idle core steals the newer half of the longest ready queue and dispatches
+//      its first process at the window boundary;
+//   2. the processes arriving during the next window are handed, in arrival order,
+//      to the core with the least load (running + ready + handed out, lowest index
+//      on ties).
+// Stretches of time no core has work for are skipped. The results depend on the
+// window length but not on the number of host threads, and a single core runs
+// exactly as the reference simulator does.
+class Multicore_Module {
+public:
+    static const unsigned int WINDOW_QUANTA = 10;  // default window [time quanta]
+
+    // simulates a core's run until it pauses at its horizon or empties
+    typedef function<void(Simulation_Module*)> CoreTask_t;
+
+private:
+    ThreadPool_Module pool;             // the threads the cores run on
+    vector<Simulation_Module*> cores;   // the run of every core
+    vector<CoreSource_Module> sources;  // the arrivals handed to every core
+    float window;                       // window length [secs] (0: WINDOW_QUANTA tqs)
+    unsigned long long windows;         // windows simulated for the last cell
+    unsigned long long steals;          // processes stolen during the last cell
+    vector<Profile_Counters> profiles;  // what every thread counted for the cell
+
+    // the runs are owned, so a system is never copied
+    Multicore_Module(const Multicore_Module&) = delete;
+    Multicore_Module& operator=(const Multicore_Module&) = delete;
+
+public:
+    // CONSTRUCTOR - MULTICORE MODULE
+    Multicore_Module(unsigned int numbOfCores, unsigned int threads = 0,
+                        float windowLength = 0.0f)
+        : pool(WorkersFor(threads, max(numbOfCores, 1u))), sources(max(numbOfCores, 1u)),
+            profiles(pool.Size()) {
+        for (size_t i = 0; i < sources.size(); i++)
+            cores.push_back(new Simulation_Module);
+        window = windowLength;
+        windows = 0;
+        steals = 0;
+    }
+
+    // DE-CONSTRUCTOR - MULTICORE MODULE
+    ~Multicore_Module() {
+        for (size_t i = 0; i < cores.size(); i++)
+            delete cores[i];
+    }
+
+    // CORES
+    // Returns the number of simulated CPUs
+    unsigned int Cores() const {
+        return (unsigned int)cores.size();
+    }
+
+    // WORKERS
+    // Returns the number of threads the cores run on
+    unsigned int Workers() const {
+        return pool.Size();
+    }
+
+    // WINDOWS
+    // Returns the number of windows the last cell took
+    unsigned long long Windows() const {
+        return windows;
+    }
+
+    // STEALS
+    // Returns the number of processes idle cores stole during the last cell
+    unsigned long long Steals() const {
+        return steals;
+    }
+
+    // RUN
+    // Simulates "workload" with a time quantum and overhead on every core, running
+    // "simulate" on each core once per window, and returns the deliverables of the
+    // whole system (the statistics end up in "stats")
+    Run_Metrics Run(const Workload_Module& workload, float timeQuantum, float overhead,
+                    Stats_Module& stats, const CoreTask_t& simulate) {
+        const float length = (window > 0.0f) ? window : WINDOW_QUANTA * timeQuantum;
+        for (size_t i = 0; i < cores.size(); i++) {
+            cores[i]->Reset(timeQuantum, overhead);
+            sources[i].Reset();
+            cores[i]->Load(sources[i]);
+        }
+        windows = 0;
+        steals = 0;
+        unsigned int next = 0;      // the next process to hand out
+        float start = 0.0f;         // the start of the next window
+        while (true) {
+            // 1. let the idle cores steal from the busy ones
+            Balance(start);
+            // 2. skip the time nobody has work for
+            if (Idle()) {
+                if (next >= workload.Size())
+                    break;
+                start = max(start, workload.GetArrivalTime(next));
+            }
+            float end = start + length;
+            if (!(end > start))
+                end = nextafterf(start, HUGE_VALF);
+            // 3. hand out the processes arriving during the window
+            next = Assign(workload, next, end);
+            // 4. simulate the window on every core
+            for (size_t i = 0; i < sources.size(); i++)
+                sources[i].SetHorizon(end);
+            RunWindow(simulate);
+            windows++;
+            start = end;
+        }
+        // the windows were counted on the pool's threads
+        for (size_t i = 0; i < profiles.size(); i++) {
+            Profile_Module::Add(profiles[i]);
+            profiles[i] = Profile_Counters();
+        }
+        return Merge(timeQuantum, overhead, stats);
+    }
+
+private:
+    // WORKERS FOR
+    // Returns the threads to run "numbOfCores" cores on: "threads" (0: one per host
+    // CPU), but no more than there are cores
+    static unsigned int WorkersFor(unsigned int threads, unsigned int numbOfCores) {
+        if (threads == 0)
+            threads = thread::hardware_concurrency();
+        return (threads == 0) ? 1 : min(threads, numbOfCores);
+    }
+
+    // LOAD
+    // Returns the load of core "i": the processes it runs, has ready and has been
+    // handed out
+    size_t Load(size_t i) {
+        return (cores[i]->Cpu().Busy() ? 1 : 0) + cores[i]->Queues()[READY].Length() +
+                sources[i].Pending();
+    }
+
+    // IDLE
+    // Returns true if no core has any work left (until more processes arrive)
+    bool Idle() {
+        for (size_t i = 0; i < cores.size(); i++) {
+            if (Load(i) != 0)
+                return false;
+        }
+        return true;
+    }
+
+    // BALANCE
+    // Lets every core that has nothing to do steal the newer half of the longest
+    // ready queue and start running it at "now"
+    void Balance(float now) {
+        if (cores.size() < 2)
+            return;
+        for (size_t thief = 0; thief < cores.size(); thief++) {
+            if (Load(thief) != 0)
+                continue;
+            size_t victim = thief;
+            unsigned int longest = 0;
+            for (size_t i = 0; i < cores.size(); i++) {
+                if (cores[i]->Queues()[READY].Length() > longest) {
+                    longest = cores[i]->Queues()[READY].Length();
+                    victim = i;
+                }
+            }
+            if (longest == 0)
+                return;
+            // the stolen processes keep their order: the oldest of them runs first
+            Queue_Module& from = cores[victim]->Queues()[READY];
+            Queue_Module& to = cores[thief]->Queues()[READY];
+            vector<uint32_t> stolen((longest + 1) / 2);
+            for (size_t k = stolen.size(); k > 0; k--)
+                stolen[k - 1] = from.DequeueBack();
+            for (size_t k = 0; k < stolen.size(); k++)
+                to.Enqueue(cores[thief]->Jobs().Adopt(cores[victim]->Jobs(), stolen[k]));
+            steals += stolen.size();
+            CPU_Module& cpu = cores[thief]->Cpu();
+            cpu.FastForwardClockTo(now);
+            cores[thief]->Scheduler()->DispatchNextProcess();
+            cpu.LoadProcess();
+        }
+    }
+
+    // ASSIGN
+    // Hands processes "next" on that arrive before "end" to the least loaded cores
+    // and returns the first process not handed out
+    unsigned int Assign(const Workload_Module& workload, unsigned int next, float end) {
+        typedef pair<size_t, size_t> Load_t;    // (load, core)
+        priority_queue<Load_t, vector<Load_t>, greater<Load_t> > loads;
+        for (size_t i = 0; i < cores.size(); i++)
+            loads.push(Load_t(Load(i), i));
+        for (; next < workload.Size() && workload.GetArrivalTime(next) < end; next++) {
+            Load_t least = loads.top();
+            loads.pop();
+            Process_t process;
+            process.processId = next;
+            process.arrivalTime = workload.GetArrivalTime(next);
+            process.serviceTime = workload.GetServiceTime(next);
+            sources[least.second].Push(process);
+            loads.push(Load_t(least.first + 1, least.second));
+        }
+        return next;
+    }
+
+    // RUN WINDOW
+    // Runs "simulate" on every core, spread over the pool's threads, and waits for
+    // all of them (the window's barrier)
+    void RunWindow(const CoreTask_t& simulate) {
+        const size_t workers = pool.Size();
+        if (workers == 1) {
+            for (size_t i = 0; i < cores.size(); i++)
+                simulate(cores[i]);
+            return;
+        }
+        for (size_t w = 0; w < workers; w++) {
+            pool.Submit([this, w, workers, &simulate](int worker) {
+                for (size_t i = w; i < cores.size(); i += workers)
+                    simulate(cores[i]);
+                Profile_Module::Take(profiles[worker]);
+            });
+        }
+        pool.Wait();
+    }
+
+    // MERGE
+    // Adds up the cores: the system finishes with its last core, and every core
+    // that ran processes takes off its final scheduler run (the windows keep the
+    // cores from knowing which run is their last)
+    Run_Metrics Merge(float timeQuantum, float overhead, Stats_Module& stats) {
+        unsigned int maxLength = 0;
+        long long lengthSum = 0;
+        long long dispatches = 0;
+        double cpuTime = 0.0;
+        stats.Reset();
+        for (size_t i = 0; i < cores.size(); i++) {
+            Simulation_Module* core = cores[i];
+            core->Scheduler()->TakeOffFinalOverhead();
+            maxLength = max(maxLength, core->Queues()[READY].MaxLength());
+            lengthSum += core->Scheduler()->GetReadyQueueLengthSum();
+            dispatches += (long long)core->Scheduler()->GetDispatchCount();
+            cpuTime = max(cpuTime, core->Cpu().GetCpuTime());
+            stats.Merge(core->Stats());
+        }
+        // computed as Scheduler_Module::GetAvgReadyQueueLength() does
+        Run_Metrics metrics;
+        metrics.overhead = overhead;
+        metrics.timeQuantum = timeQuantum;
+        metrics.maxReadyLength = maxLength;
+        metrics.avgReadyLength = (dispatches > 0) ? ((float)lengthSum / dispatches) : 0.0f;
+        metrics.cpuTime = cpuTime;
+        metrics.dispatches = (unsigned long long)dispatches;
+        metrics.stats = &stats;
+        return metrics;
+    }
+};
+
+#endif // RR_MULTICORE_MODULE_H_
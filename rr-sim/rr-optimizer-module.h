@@ -0,0 +1,326 @@
+#ifndef RR_OPTIMIZER_MODULE_H_
+#define RR_OPTIMIZER_MODULE_H_
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <functional>
+#include <algorithm>
+#include <stdint.h>
+using namespace std;
+
+#include "rr-simulation-module.h"
+#include "rr-results-module.h"
+#include "rr-threadpool-module.h"
+
+// Searches the time quantum that minimizes a metric of a loaded workload, for every
+// overhead of the sweep, instead of simulating a fixed grid of time quanta. A
+// search works on log(tq) between a smallest and a largest time quantum:
+//   1. a scan simulates SCAN_POINTS time quanta spread evenly over the range (every
+//      other one first, then the ones in between) and brackets the best of them by
+//      its neighbours;
+//   2. every round then simulates one point on each side of the best point so far,
+//      a golden section into each half of the bracket, and shrinks the bracket to
+//      the neighbours of the new best point, until its ends are within the
+//      tolerance of each other.
+// The candidates of a round (of every overhead's search) are simulated in parallel.
+// A candidate only matters if it beats the best point of its search, so it is
+// abandoned as soon as the part of the run simulated so far shows that it cannot
+// (see Hopeless); the search takes the same steps as it would with complete runs.
+class Optimizer_Module {
+public:
+    // The metric the time quantum is chosen for
+    enum Objective_t {
+        OBJ_AVG_WAIT = 0,           // the average wait time
+        OBJ_AVG_TURN_AROUND,        // the average turn around time
+        OBJ_P99_TURN_AROUND         // the 99th percentile of the turn around time
+    };
+
+    // simulates "workload" with a time quantum and overhead on a run, abandoning it
+    // (returning false) once it cannot come out below "bound"
+    typedef function<bool(Simulation_Module*, float, float, double)> EvaluateTask_t;
+
+    // The outcome of one overhead's search
+    struct Search_Result {
+        float overhead;             // the scheduler overhead [secs]
+        float timeQuantum;          // the best time quantum found [secs]
+        double value;               // its objective value
+        Result_Row row;             // its results (simulation number unset)
+        unsigned int simulations;   // candidates simulated (complete or not)
+        unsigned int abandoned;     // candidates abandoned early
+    };
+
+    static const unsigned int SCAN_POINTS = 8;      // time quanta of the first scan
+    static const unsigned int CHECKS = 32;          // abandon checks per candidate
+
+private:
+    static constexpr double GOLDEN = 0.3819660112501051;    // 2 - golden ratio
+
+    // A time quantum being simulated
+    struct Candidate {
+        size_t search;          // the search it belongs to
+        float overhead;         // its overhead [secs]
+        double x;               // log of the time quantum
+        float timeQuantum;      // [secs]
+        double bound;           // the value it has to come out below
+        bool complete;          // simulated to the end (not abandoned)
+        double value;           // objective value (if complete)
+        Result_Row row;         // results (if complete)
+    };
+
+    // The state of one overhead's search
+    struct Search {
+        float overhead;         // the overhead searched for
+        double a, b;            // the bracket [log tq]
+        double best;            // the best point found [log tq]
+        Search_Result result;   // the best candidate so far and the counts
+    };
+
+    ThreadPool_Module pool;             // the threads the candidates run on
+    vector<Simulation_Module*> runs;    // one run per candidate of a round
+    Objective_t objective;
+    float smallest;                     // the smallest time quantum tried [secs]
+    float largest;                      // the largest time quantum tried [secs]
+    double tolerance;                   // relative width the brackets shrink to
+
+    // the runs are owned, so an optimizer is never copied
+    Optimizer_Module(const Optimizer_Module&) = delete;
+    Optimizer_Module& operator=(const Optimizer_Module&) = delete;
+
+public:
+    // CONSTRUCTOR - OPTIMIZER MODULE
+    Optimizer_Module(Objective_t goal, float minTimeQuantum, float maxTimeQuantum,
+                        double relTolerance = 0.01, unsigned int threads = 0)
+        : pool(threads) {
+        objective = goal;
+        smallest = minTimeQuantum;
+        largest = maxTimeQuantum;
+        tolerance = relTolerance;
+    }
+
+    // DE-CONSTRUCTOR - OPTIMIZER MODULE
+    ~Optimizer_Module() {
+        for (size_t i = 0; i < runs.size(); i++)
+            delete runs[i];
+    }
+
+    // PARSE OBJECTIVE
+    // Reads an objective name ("avg-wait", "avg-turnaround" or "p99-turnaround");
+    // returns false if there is no such objective
+    static bool ParseObjective(const string& name, Objective_t& goal) {
+        if (name == "avg-wait")
+            goal = OBJ_AVG_WAIT;
+        else if (name == "avg-turnaround")
+            goal = OBJ_AVG_TURN_AROUND;
+        else if (name == "p99-turnaround")
+            goal = OBJ_P99_TURN_AROUND;
+        else
+            return false;
+        return true;
+    }
+
+    // OBJECTIVE NAME
+    // Returns the name of an objective (as printed in the analysis output)
+    static const char* ObjectiveName(Objective_t goal) {
+        switch (goal) {
+            case OBJ_AVG_WAIT:          return "Average Wait Time";
+            case OBJ_AVG_TURN_AROUND:   return "Average Turn Around Time";
+            case OBJ_P99_TURN_AROUND:   return "p99 Turn Around Time";
+        }
+        return "";
+    }
+
+    // GET OBJECTIVE
+    // Returns the metric the time quantum is chosen for
+    Objective_t GetObjective() const {
+        return objective;
+    }
+
+    // VALUE OF
+    // Returns the objective value of a run's results
+    static double ValueOf(Objective_t goal, const Result_Row& row) {
+        switch (goal) {
+            case OBJ_AVG_WAIT:          return row.values[Result_Row::RC_AVG_WAIT];
+            case OBJ_AVG_TURN_AROUND:   return row.values[Result_Row::RC_AVG_TURN_AROUND];
+            case OBJ_P99_TURN_AROUND:   return row.values[Result_Row::RC_TURN_AROUND_P99];
+        }
+        return 0.0;
+    }
+
+    // HOPELESS
+    // Returns true if a run of "total" processes whose finished processes so far
+    // are "stats" is certain not to come out below "bound": the sums only grow as
+    // more processes finish (no time is negative), and the 99th percentile is
+    // beyond "bound" once more processes than the top 1% certainly are
+    static bool Hopeless(Objective_t goal, const Stats_Module& stats, uint64_t total,
+                            double bound) {
+        if (total == 0 || !isfinite(bound))
+            return false;
+        switch (goal) {
+            case OBJ_AVG_WAIT:
+                return (float)(stats.GetWaitTimeSum() / (double)total) >= bound;
+            case OBJ_AVG_TURN_AROUND:
+                return (float)(stats.GetTurnAroundTimeSum() / (double)total) >= bound;
+            case OBJ_P99_TURN_AROUND: {
+                // computed as Histogram_Module::Percentile() does
+                uint64_t rank = (uint64_t)ceil(99.0 / 100.0 * (double)total);
+                if (rank < 1)
+                    rank = 1;
+                return stats.TurnAroundTimes().CountAbove(bound) > total - rank;
+            }
+        }
+        return false;
+    }
+
+    // RUN
+    // Searches the best time quantum for every one of "count" overheads, running
+    // "evaluate" on every candidate, and returns the outcome of every search
+    vector<Search_Result> Run(const float* overheads, int count,
+                                const EvaluateTask_t& evaluate) {
+        const double lo = log((double)smallest);
+        const double hi = log((double)largest);
+        vector<Search> searches(count);
+        vector<Candidate> round;
+        for (int s = 0; s < count; s++) {
+            Search& search = searches[s];
+            search.overhead = overheads[s];
+            search.a = lo;
+            search.b = hi;
+            search.best = lo;
+            search.result.overhead = overheads[s];
+            search.result.timeQuantum = smallest;
+            search.result.value = HUGE_VAL;
+            search.result.simulations = 0;
+            search.result.abandoned = 0;
+        }
+        // 1. the scan: the even points have nothing to beat yet, the odd ones have
+        // to beat the best even point
+        vector<double> points(SCAN_POINTS);
+        for (unsigned int i = 0; i < SCAN_POINTS; i++)
+            points[i] = (SCAN_POINTS > 1) ? lo + (hi - lo) * i / (SCAN_POINTS - 1) : lo;
+        for (unsigned int parity = 0; parity < 2; parity++) {
+            round.clear();
+            for (int s = 0; s < count; s++) {
+                for (unsigned int i = parity; i < SCAN_POINTS; i += 2)
+                    round.push_back(MakeCandidate(s, searches[s].overhead, points[i],
+                                                    searches[s].result.value));
+            }
+            Simulate(round, evaluate);
+            for (size_t i = 0; i < round.size(); i++)
+                Take(searches[round[i].search], round[i]);
+        }
+        for (int s = 0; s < count; s++) {
+            Search& search = searches[s];
+            size_t bestAt = find(points.begin(), points.end(), search.best) - points.begin();
+            search.a = points[(bestAt > 0) ? bestAt - 1 : 0];
+            search.b = points[min(bestAt + 1, (size_t)SCAN_POINTS - 1)];
+        }
+        // 2. the golden section rounds
+        const double width = log(1.0 + tolerance);
+        while (true) {
+            round.clear();
+            for (int s = 0; s < count; s++) {
+                Search& search = searches[s];
+                if (search.b - search.a <= width)
+                    continue;
+                // (the bracket is wider than the tolerance, so at least one side
+                // is wider than half of it)
+                double bound = search.result.value;
+                double x = search.best - GOLDEN * (search.best - search.a);
+                if (search.best - search.a > width / 2)
+                    round.push_back(MakeCandidate(s, search.overhead, x, bound));
+                x = search.best + GOLDEN * (search.b - search.best);
+                if (search.b - search.best > width / 2)
+                    round.push_back(MakeCandidate(s, search.overhead, x, bound));
+            }
+            if (round.empty())
+                break;
+            Simulate(round, evaluate);
+            for (size_t i = 0; i < round.size(); ) {
+                Search& search = searches[round[i].search];
+                // the candidates of a search are on either side of its best point
+                double left = search.a, right = search.b;
+                double previous = search.best;
+                size_t j = i;
+                for (; j < round.size() && round[j].search == round[i].search; j++) {
+                    Take(search, round[j]);
+                    if (round[j].x < previous)
+                        left = round[j].x;
+                    else
+                        right = round[j].x;
+                }
+                // shrink the bracket to the neighbours of the best point
+                if (search.best == previous) {
+                    search.a = left;
+                    search.b = right;
+                } else if (search.best < previous) {
+                    search.b = previous;
+                } else {
+                    search.a = previous;
+                }
+                i = j;
+            }
+        }
+        vector<Search_Result> results;
+        for (int s = 0; s < count; s++)
+            results.push_back(searches[s].result);
+        return results;
+    }
+
+private:
+    // MAKE CANDIDATE
+    // Returns a candidate of search "search" (for "overhead") at log(tq) "x" that
+    // has to come out below "bound"
+    static Candidate MakeCandidate(size_t search, float overhead, double x,
+                                    double bound) {
+        Candidate candidate;
+        candidate.search = search;
+        candidate.overhead = overhead;
+        candidate.x = x;
+        candidate.timeQuantum = (float)exp(x);
+        candidate.bound = bound;
+        candidate.complete = false;
+        candidate.value = HUGE_VAL;
+        return candidate;
+    }
+
+    // TAKE
+    // Counts a simulated candidate and makes it the best point of its search if it
+    // beats it (returns true if it does)
+    static bool Take(Search& search, const Candidate& candidate) {
+        search.result.simulations++;
+        if (!candidate.complete) {
+            search.result.abandoned++;
+            return false;
+        }
+        if (!(candidate.value < search.result.value))
+            return false;
+        search.best = candidate.x;
+        search.result.timeQuantum = candidate.timeQuantum;
+        search.result.value = candidate.value;
+        search.result.row = candidate.row;
+        return true;
+    }
+
+    // SIMULATE
+    // Simulates every candidate of a round on the pool (one run each)
+    void Simulate(vector<Candidate>& round, const EvaluateTask_t& evaluate) {
+        while (runs.size() < round.size())
+            runs.push_back(new Simulation_Module);
+        for (size_t i = 0; i < round.size(); i++) {
+            Candidate* candidate = &round[i];
+            Simulation_Module* run = runs[i];
+            pool.Submit([this, candidate, run, &evaluate](int) {
+                candidate->complete = evaluate(run, candidate->timeQuantum,
+                                                candidate->overhead, candidate->bound);
+                if (candidate->complete) {
+                    candidate->row = Result_Row::From(run->Metrics(), 0);
+                    candidate->value = ValueOf(objective, candidate->row);
+                }
+            });
+        }
+        pool.Wait();
+    }
+};
+
+#endif // RR_OPTIMIZER_MODULE_H_
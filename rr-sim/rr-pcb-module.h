@@ -6,6 +6,8 @@
 #include <iostream>
 using namespace std;
 
+// The control block of what the CPU runs besides the jobs of the job table (see
+// JobTable_Module): the scheduler, which runs for its overhead on every interrupt
 class PCB_Module {
 public:
     // Describes a process's state
@@ -15,7 +17,7 @@ public:
         PS_RUNNING,         // when running on the cpu
         PS_TERMINATED       // when finished running and time left = 0
     };
-    friend class Queue_Module;
+    friend class Checkpoint_Module;
     
 protected:
     unsigned int processId; // process ID
@@ -25,7 +27,6 @@ protected:
     float startTime;        // time this process started executing [CPU clock]
     float endTime;          // time this process terminated (exited system) [CPU clock]
     ProcessState_t state;   // state of the process
-    PCB_Module* next;       // used to point to the next process on the queue
     
 public:
     // CONSTRUCTOR - PCB MODULE
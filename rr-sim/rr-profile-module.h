@@ -0,0 +1,207 @@
+#ifndef RR_PROFILE_MODULE_H_
+#define RR_PROFILE_MODULE_H_
+
+#include <iostream>
+#include <stdint.h>
+#if defined(RR_SIM_PROFILE) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#elif defined(RR_SIM_PROFILE)
+#include <chrono>
+#endif
+using namespace std;
+
+// Hot path profiling of the reference simulator (CPU_Module, Scheduler_Module).
+// Everything here compiles to nothing unless RR_SIM_PROFILE is defined (cmake
+// -DRR_SIM_PROFILE=ON). When it is, every thread counts into its own cache line
+// aligned block, so workers never share a counter, and phases are timed with the
+// time stamp counter (steady_clock nanoseconds where there is none). A sweep worker
+// runs one cell at a time, so resetting its block when a cell starts and reporting
+// it when the cell ends gives the figures of that cell. A cell that farms its work
+// out to helper threads (Split_Module, Multicore_Module) takes their blocks when
+// each task ends and adds them to the worker's before it reports.
+
+// ==== COUNTERS ====================================================================== //
+enum ProfileCounter_t {
+    PC_QUANTA = 0,          // time slices executed (CPU_Module::Execute)
+    PC_SCHEDULER_RUNS,      // scheduler runs executed (CPU_Module::Interrupt)
+    PC_CONTEXT_SWITCHES,    // processes dispatched (including fast forwarded quanta)
+    PC_ARRIVALS,            // processes admitted into the ready queue
+    PC_IDLE_FAST_FORWARDS,  // idle CPU clock jumps (CPU_Module::FastForwardClockTo)
+    PC_SKIPPED_QUANTA,      // quanta skipped by Scheduler_Module::FastForward
+    NUMB_OF_COUNTERS
+};
+
+// ==== PHASES ======================================================================== //
+enum ProfilePhase_t {
+    PP_EXECUTE = 0,         // CPU_Module::Execute (a time slice or a scheduler run)
+    PP_INTERRUPT,           // CPU_Module::Interrupt (includes the scheduler run)
+    PP_CHECK_ARRIVALS,      // Scheduler_Module::CheckForNewProcesses
+    PP_DISPATCH,            // Scheduler_Module::DispatchNextProcess
+    PP_EVALUATE,            // Scheduler_Module::EvaluateSavedProcess
+    PP_FAST_FORWARD,        // Scheduler_Module::FastForward
+    NUMB_OF_PHASES
+};
+
+// One thread's counters (a whole number of cache lines)
+struct alignas(64) Profile_Counters {
+    uint64_t counts[NUMB_OF_COUNTERS];  // event counts
+    uint64_t calls[NUMB_OF_PHASES];     // times each phase was entered
+    uint64_t ticks[NUMB_OF_PHASES];     // time spent in each phase (inclusive)
+};
+
+class Profile_Module {
+public:
+    // ENABLED
+    // Returns true if the simulator was built with profiling
+    static constexpr bool Enabled() {
+#ifdef RR_SIM_PROFILE
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // COUNT
+    // Adds "amount" to a counter of the calling thread
+    static void Count(ProfileCounter_t counter, uint64_t amount = 1) {
+#ifdef RR_SIM_PROFILE
+        Local().counts[counter] += amount;
+#else
+        (void)counter;
+        (void)amount;
+#endif
+    }
+
+    // NOW
+    // Returns the current time stamp (0 without profiling)
+    static uint64_t Now() {
+#if defined(RR_SIM_PROFILE) && (defined(__x86_64__) || defined(__i386__))
+        return __rdtsc();
+#elif defined(RR_SIM_PROFILE)
+        return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(
+                    chrono::steady_clock::now().time_since_epoch()).count();
+#else
+        return 0;
+#endif
+    }
+
+    // ADD TIME
+    // Books "ticks" (and one call) to a phase of the calling thread
+    static void AddTime(ProfilePhase_t phase, uint64_t ticks) {
+#ifdef RR_SIM_PROFILE
+        Profile_Counters& local = Local();
+        local.calls[phase]++;
+        local.ticks[phase] += ticks;
+#else
+        (void)phase;
+        (void)ticks;
+#endif
+    }
+
+    // RESET
+    // Zeroes the calling thread's counters
+    static void Reset() {
+#ifdef RR_SIM_PROFILE
+        Local() = Profile_Counters();
+#endif
+    }
+
+    // TAKE
+    // Adds the calling thread's counters to "into" and zeroes them (a helper thread
+    // hands over what it counted for another thread's cell)
+    static void Take(Profile_Counters& into) {
+#ifdef RR_SIM_PROFILE
+        Profile_Counters& local = Local();
+        Accumulate(into, local);
+        local = Profile_Counters();
+#else
+        (void)into;
+#endif
+    }
+
+    // ADD
+    // Adds counters taken on helper threads to the calling thread's
+    static void Add(const Profile_Counters& counters) {
+#ifdef RR_SIM_PROFILE
+        Accumulate(Local(), counters);
+#else
+        (void)counters;
+#endif
+    }
+
+    // REPORT
+    // Writes the calling thread's counters (nothing without profiling)
+    static void Report(ostream& out) {
+#ifdef RR_SIM_PROFILE
+        static const char* counterNames[NUMB_OF_COUNTERS] = {
+            "Quanta executed", "Scheduler runs", "Context switches",
+            "Arrivals admitted", "Idle fast forwards", "Quanta fast forwarded"
+        };
+        static const char* phaseNames[NUMB_OF_PHASES] = {
+            "Execute", "Interrupt", "CheckForNewProcesses", "DispatchNextProcess",
+            "EvaluateSavedProcess", "FastForward"
+        };
+        const Profile_Counters& local = Local();
+        out << "Profile:\n";
+        for (int i = 0; i < NUMB_OF_COUNTERS; i++)
+            out << "\t" << counterNames[i] << " = " << local.counts[i] << "\n";
+        for (int i = 0; i < NUMB_OF_PHASES; i++) {
+            out << "\t" << phaseNames[i] << " = " << local.ticks[i] << " ticks in "
+                << local.calls[i] << " calls";
+            if (local.calls[i] > 0)
+                out << " (" << (double)local.ticks[i] / local.calls[i] << " per call)";
+            out << "\n";
+        }
+#else
+        (void)out;
+#endif
+    }
+
+private:
+#ifdef RR_SIM_PROFILE
+    // LOCAL
+    // Returns the calling thread's counters
+    static Profile_Counters& Local() {
+        static thread_local Profile_Counters counters = Profile_Counters();
+        return counters;
+    }
+
+    // ACCUMULATE
+    // Adds "from" to "into"
+    static void Accumulate(Profile_Counters& into, const Profile_Counters& from) {
+        for (int i = 0; i < NUMB_OF_COUNTERS; i++)
+            into.counts[i] += from.counts[i];
+        for (int i = 0; i < NUMB_OF_PHASES; i++) {
+            into.calls[i] += from.calls[i];
+            into.ticks[i] += from.ticks[i];
+        }
+    }
+#endif
+};
+
+// Times a phase from its construction to the end of its scope
+class Profile_Timer {
+#ifdef RR_SIM_PROFILE
+private:
+    ProfilePhase_t phase;   // the phase being timed
+    uint64_t start;         // when it started
+
+public:
+    // CONSTRUCTOR - PROFILE TIMER
+    Profile_Timer(ProfilePhase_t timedPhase) {
+        phase = timedPhase;
+        start = Profile_Module::Now();
+    }
+
+    // DE-CONSTRUCTOR - PROFILE TIMER
+    ~Profile_Timer() {
+        Profile_Module::AddTime(phase, Profile_Module::Now() - start);
+    }
+#else
+public:
+    // CONSTRUCTOR - PROFILE TIMER
+    Profile_Timer(ProfilePhase_t) { /* no implementation */ }
+#endif
+};
+
+#endif // RR_PROFILE_MODULE_H_
@@ -1,20 +1,31 @@
 #ifndef RR_QUEUE_MODULE_H_
 #define RR_QUEUE_MODULE_H_
 
-#include "rr-pcb-module.h"
+#include <vector>
+#include <stdint.h>
+using namespace std;
 
+#include "rr-jobtable-module.h"
+
+// A FIFO of jobs, where a job is its 32-bit slot in a job table (see
+// JobTable_Module). The slots live in a contiguous ring whose size is a power
+// of two and doubles when full, so rotating a process (dequeue at the head,
+// enqueue at the tail) touches a couple of cache lines of the ring instead of the
+// jobs themselves. The ring keeps its memory across Reset().
 class Queue_Module {
 private:
-    PCB_Module* head;       // points to the "head" of the queue
-    PCB_Module* tail;       // points to the "tail" of the queue
+    vector<uint32_t> ring;  // the queued jobs (power of two sized)
+    unsigned int head;      // index of the "head" of the queue in the ring
     unsigned int size;      // states the size of the queue
     unsigned int maxLength; // states the max length of the queue
     
+    // Allows snapshots to save and restore this class
+    friend class Checkpoint_Module;
+    
 public:
     // CONSTRUCTOR - QUEUE MODULE
-    Queue_Module() {
-        head = NULL;
-        tail = NULL;
+    Queue_Module() : ring(16) {
+        head = 0;
         size = 0;
         maxLength = 0;
     }
@@ -22,53 +33,53 @@ public:
     // DE-CONSTRUCTOR - QUEUE MODULE
     ~Queue_Module() { /* no implementation */ }
     
+    // RESET
+    // Forgets every queued job and the max length (the job table is not touched)
+    void Reset() {
+        head = 0;
+        size = 0;
+        maxLength = 0;
+    }
+    
     // ENQUEUE
-    // Receives a "new" process and places it at the end of the queue
-    void Enqueue(PCB_Module* process) {
-        if (process != NULL) {
-            // if the head & tail are not NULL, add the process to the end of the queue
-            if (head != NULL && tail != NULL) {
-                tail->next = process;
-                tail = tail->next;
-            // the queue is empty, so make the process the head of the queue
-            } else {
-                head = process;
-                tail = head;
-            }
-            tail->next = NULL;
-            size++;
-            // if the size has grown larger than the max length, log the new max length
-            if (size > maxLength) {
-                maxLength = size;
-            }
+    // Receives a "new" job and places it at the end of the queue
+    void Enqueue(uint32_t job) {
+        // if the ring is full, double it
+        if (size == ring.size())
+            Grow();
+        ring[(head + size) & (ring.size() - 1)] = job;
+        size++;
+        // if the size has grown larger than the max length, log the new max length
+        if (size > maxLength) {
+            maxLength = size;
         }
     }
     
     // DEQUEUE
-    // Removes and returns the process at the beginning of the queue
-    PCB_Module* Dequeue() {
-        if (head == NULL)
-            return NULL;
-        PCB_Module* process = head;
-        head = process->next;
-        process->next = NULL;
+    // Removes and returns the job at the beginning of the queue (the queue must
+    // not be empty)
+    uint32_t Dequeue() {
+        uint32_t job = ring[head];
+        head = (head + 1) & (ring.size() - 1);
         size--;
-        if (Length() == 0) {
-            head = NULL;
-            tail = head;
-        }   
-        return process;
+        return job;
     }
     
-    // FRONT
-    // Retrieves (a copy of) the process at the front of the queue
-    PCB_Module Front() {
-        if (Length() <= 0)
+    // DEQUEUE BACK
+    // Removes and returns the job at the end of the queue, the one queued last (the
+    // queue must not be empty)
+    uint32_t DequeueBack() {
+        size--;
+        return ring[(head + size) & (ring.size() - 1)];
+    }
+    
+    // PEEK
+    // Returns the job at the front of the queue without removing it (NULL if the
+    // queue is empty)
+    const uint32_t* Peek() const {
+        if (size == 0)
             return NULL;
-        // creates a copy of the process at the front of the queue
-        PCB_Module tmp(head->GetProcessId(), head->GetArrivalTime(),
-                        head->GetServiceTime());
-        return tmp;
+        return &ring[head];
     }
     
     // LENGTH
@@ -79,7 +90,7 @@ public:
     
     // MAX LENGTH
     // Returns the maximum length of the queue
-    unsigned int MaxLength() {
+    unsigned int MaxLength() const {
         return maxLength;
     }
     
@@ -90,23 +101,32 @@ public:
     }
     
     // PRINT QUEUE
-    // Prints all the process control blocks (PCBs) in the queue
-    void PrintQueue() {
-        PCB_Module* iter = head;
+    // Prints all the jobs in the queue, looking them up in "table"
+    void PrintQueue(const JobTable_Module& table) {
         cout << endl;
-        for (; iter != NULL; iter = iter->next) {
-            cout << "PID:       " << iter->GetProcessId() << endl;
-            cout << "ArrTime:   " << iter->GetArrivalTime() << endl;
-            cout << "SerTime:   " << iter->GetServiceTime() << endl;
-            if (iter->BeganExecution() > 0.0f) {
-                cout << "StTime:    " << iter->BeganExecution() << endl;
-                cout << "EdTime:    " << iter->CompletedExecution() << endl;
-            }
+        for (unsigned int i = 0; i < size; i++) {
+            uint32_t iter = ring[(head + i) & (ring.size() - 1)];
+            cout << "PID:       " << table.GetProcessId(iter) << endl;
+            cout << "ArrTime:   " << table.GetArrivalTime(iter) << endl;
+            cout << "SerTime:   " << table.GetServiceTime(iter) << endl;
+            cout << "TimeLeft:  " << table.GetTimeRemaining(iter) << endl;
+            if (table.BeganExecution(iter) > 0.0f)
+                cout << "StTime:    " << table.BeganExecution(iter) << endl;
             cout << endl;
         }
-        iter = NULL;
         cout << endl << endl;
     }
+
+private:
+    // GROW
+    // Doubles the ring, moving the queued jobs to its front (in order)
+    void Grow() {
+        vector<uint32_t> bigger(ring.size() * 2);
+        for (unsigned int i = 0; i < size; i++)
+            bigger[i] = ring[(head + i) & (ring.size() - 1)];
+        ring.swap(bigger);
+        head = 0;
+    }
 };
 
 #endif // RR_QUEUE_MODULE_H_
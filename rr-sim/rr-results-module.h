@@ -0,0 +1,285 @@
+#ifndef RR_RESULTS_MODULE_H_
+#define RR_RESULTS_MODULE_H_
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <fstream>
+#include <algorithm>
+#include <stdint.h>
+using namespace std;
+
+#include "rr-stats-module.h"
+
+// Structured results of a sweep, one row per simulation. Workers add their rows as
+// their cells finish (in any order, from any thread); the rows are kept in memory
+// and the whole file is encoded in grid order and written in a single write once
+// the sweep is over. The backends are CSV, JSON lines and a binary columnar file:
+//   header  | char magic[8] = "RRRESULT" | uint32 version | uint32 columns |
+//           | uint64 rows                                                 |
+//   names   | char name[24] x columns (NUL padded)                        |
+//   columns | double value[rows] x columns                                |
+// (all fields little-endian, byte swapped on big-endian hosts; every column is
+// stored as doubles).
+const char RR_RESULTS_MAGIC[8] = { 'R', 'R', 'R', 'E', 'S', 'U', 'L', 'T' };
+const uint32_t RR_RESULTS_VERSION = 1;
+
+// The results of one simulation
+struct Result_Row {
+    enum Column_t {
+        RC_SIMULATION = 0,      // the 1-based simulation number
+        RC_TIME_QUANTUM,        // [secs]
+        RC_OVERHEAD,            // [secs]
+        RC_MAX_READY_LENGTH,
+        RC_AVG_READY_LENGTH,
+        RC_CPU_TIME,            // [secs]
+        RC_DISPATCHES,
+        RC_COMPLETED,           // processes that finished
+        RC_AVG_TURN_AROUND,     // [secs]
+        RC_AVG_WAIT,            // [secs]
+        RC_TURN_AROUND_P50, RC_TURN_AROUND_P95, RC_TURN_AROUND_P99, RC_TURN_AROUND_MAX,
+        RC_WAIT_P50, RC_WAIT_P95, RC_WAIT_P99, RC_WAIT_MAX,
+        RC_SLOWDOWN_P50, RC_SLOWDOWN_P95, RC_SLOWDOWN_P99, RC_SLOWDOWN_MAX,
+        NUMB_OF_COLUMNS
+    };
+
+    double values[NUMB_OF_COLUMNS];
+
+    // NAME
+    // Returns the name of a column
+    static const char* Name(int column) {
+        static const char* names[NUMB_OF_COLUMNS] = {
+            "simulation", "tq", "overhead", "max_ready_length", "avg_ready_length",
+            "cpu_time", "dispatches", "completed", "avg_turn_around", "avg_wait",
+            "turn_around_p50", "turn_around_p95", "turn_around_p99", "turn_around_max",
+            "wait_p50", "wait_p95", "wait_p99", "wait_max",
+            "slowdown_p50", "slowdown_p95", "slowdown_p99", "slowdown_max"
+        };
+        return names[column];
+    }
+
+    // FROM
+    // Returns the results of simulation #count
+    static Result_Row From(const Run_Metrics& metrics, int count) {
+        const Stats_Module& stats = *metrics.stats;
+        Result_Row row;
+        double* v = row.values;
+        v[RC_SIMULATION] = count;
+        v[RC_TIME_QUANTUM] = metrics.timeQuantum;
+        v[RC_OVERHEAD] = metrics.overhead;
+        v[RC_MAX_READY_LENGTH] = metrics.maxReadyLength;
+        v[RC_AVG_READY_LENGTH] = metrics.avgReadyLength;
+        v[RC_CPU_TIME] = metrics.cpuTime;
+        v[RC_DISPATCHES] = (double)metrics.dispatches;
+        v[RC_COMPLETED] = (double)stats.Completed();
+        v[RC_AVG_TURN_AROUND] = stats.GetAvgTurnAroundTime();
+        v[RC_AVG_WAIT] = stats.GetAvgWaitTime();
+        const Histogram_Module* histograms[] = {
+            &stats.TurnAroundTimes(), &stats.WaitTimes(), &stats.Slowdowns()
+        };
+        for (int i = 0; i < 3; i++) {
+            double* p = &v[RC_TURN_AROUND_P50 + 4 * i];
+            p[0] = histograms[i]->Percentile(50);
+            p[1] = histograms[i]->Percentile(95);
+            p[2] = histograms[i]->Percentile(99);
+            p[3] = histograms[i]->Max();
+        }
+        return row;
+    }
+};
+
+class Results_Module {
+private:
+    mutex lock;                 // guards rows (workers add concurrently)
+    vector<Result_Row> rows;    // the rows added so far (in completion order)
+
+public:
+    // CONSTRUCTOR - RESULTS MODULE
+    Results_Module() { /* no implementation */ }
+
+    // DE-CONSTRUCTOR - RESULTS MODULE
+    virtual ~Results_Module() { /* no implementation */ }
+
+    // CREATE
+    // Returns a new sink for "format" ("csv", "jsonl" or "bin"), or NULL if there is
+    // no such format
+    static Results_Module* Create(const string& format);
+
+    // FORMAT FOR
+    // Returns the format a results file name implies (csv unless it ends in .jsonl
+    // or .bin)
+    static string FormatFor(const string& fileStr) {
+        size_t dot = fileStr.rfind('.');
+        string extension = (dot == string::npos) ? "" : fileStr.substr(dot + 1);
+        return (extension == "jsonl" || extension == "bin") ? extension : "csv";
+    }
+
+    // ADD
+    // Adds the results of simulation #count (safe to call from any worker)
+    void Add(const Run_Metrics& metrics, int count) {
+        Add(Result_Row::From(metrics, count));
+    }
+
+    // ADD
+    // Adds a row (safe to call from any worker)
+    void Add(const Result_Row& row) {
+        lock_guard<mutex> guard(lock);
+        rows.push_back(row);
+    }
+
+    // TAKE
+    // Removes the row of simulation #count and returns it in "row" (false if it has
+    // not been added)
+    bool Take(int count, Result_Row& row) {
+        lock_guard<mutex> guard(lock);
+        for (size_t i = 0; i < rows.size(); i++) {
+            if (rows[i].values[Result_Row::RC_SIMULATION] == count) {
+                row = rows[i];
+                rows.erase(rows.begin() + i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // CLEAR
+    // Forgets every row (before the simulations report again)
+    void Clear() {
+        lock_guard<mutex> guard(lock);
+        rows.clear();
+    }
+
+    // WRITE
+    // Writes every row in simulation order to "fileStr" in one write (false if the
+    // file could not be written)
+    bool Write(const char* fileStr) {
+        lock_guard<mutex> guard(lock);
+        sort(rows.begin(), rows.end(), [](const Result_Row& a, const Result_Row& b) {
+            return a.values[Result_Row::RC_SIMULATION] < b.values[Result_Row::RC_SIMULATION];
+        });
+        string buffer;
+        Encode(rows, buffer);
+        ofstream out(fileStr, ios::binary | ios::trunc);
+        out.write(buffer.data(), (streamsize)buffer.size());
+        out.close();
+        return !out.fail();
+    }
+
+protected:
+    // ENCODE
+    // Appends the whole file for "rows" to "buffer"
+    virtual void Encode(const vector<Result_Row>& rows, string& buffer) const = 0;
+
+    // APPEND NUMBER
+    // Appends a value in the shortest form that reads back as the same float (the
+    // simulators keep their metrics in floats); counts are written exactly
+    static void AppendNumber(string& buffer, double value) {
+        char text[32];
+        if (value == floor(value) && fabs(value) < 9007199254740992.0) {
+            snprintf(text, sizeof(text), "%.0f", value);
+            buffer += text;
+            return;
+        }
+        for (int digits = 6; digits <= 9; digits++) {
+            snprintf(text, sizeof(text), "%.*g", digits, value);
+            if ((float)strtod(text, NULL) == (float)value)
+                break;
+        }
+        buffer += text;
+    }
+};
+
+// One comma separated row per simulation, after a header row of column names
+class CsvResults_Module : public Results_Module {
+protected:
+    void Encode(const vector<Result_Row>& rows, string& buffer) const override {
+        for (int c = 0; c < Result_Row::NUMB_OF_COLUMNS; c++) {
+            buffer += (c > 0) ? "," : "";
+            buffer += Result_Row::Name(c);
+        }
+        buffer += "\n";
+        for (size_t r = 0; r < rows.size(); r++) {
+            for (int c = 0; c < Result_Row::NUMB_OF_COLUMNS; c++) {
+                buffer += (c > 0) ? "," : "";
+                AppendNumber(buffer, rows[r].values[c]);
+            }
+            buffer += "\n";
+        }
+    }
+};
+
+// One JSON object per simulation per line
+class JsonResults_Module : public Results_Module {
+protected:
+    void Encode(const vector<Result_Row>& rows, string& buffer) const override {
+        for (size_t r = 0; r < rows.size(); r++) {
+            for (int c = 0; c < Result_Row::NUMB_OF_COLUMNS; c++) {
+                buffer += (c > 0) ? ",\"" : "{\"";
+                buffer += Result_Row::Name(c);
+                buffer += "\":";
+                // JSON has no NaN or infinity (e.g. the averages of an empty run)
+                if (isfinite(rows[r].values[c]))
+                    AppendNumber(buffer, rows[r].values[c]);
+                else
+                    buffer += "null";
+            }
+            buffer += "}\n";
+        }
+    }
+};
+
+// The binary columnar file (see the format above)
+class ColumnarResults_Module : public Results_Module {
+public:
+    static const size_t NAME_SIZE = 24;
+
+protected:
+    void Encode(const vector<Result_Row>& rows, string& buffer) const override {
+        uint32_t version = RR_RESULTS_VERSION;
+        uint32_t columns = Result_Row::NUMB_OF_COLUMNS;
+        uint64_t count = rows.size();
+        buffer.append(RR_RESULTS_MAGIC, sizeof(RR_RESULTS_MAGIC));
+        AppendLittleEndian(buffer, version);
+        AppendLittleEndian(buffer, columns);
+        AppendLittleEndian(buffer, count);
+        for (int c = 0; c < Result_Row::NUMB_OF_COLUMNS; c++) {
+            char name[NAME_SIZE];
+            memset(name, 0, sizeof(name));
+            strncpy(name, Result_Row::Name(c), NAME_SIZE - 1);
+            buffer.append(name, NAME_SIZE);
+        }
+        for (int c = 0; c < Result_Row::NUMB_OF_COLUMNS; c++) {
+            for (size_t r = 0; r < rows.size(); r++) {
+                uint64_t bits;
+                memcpy(&bits, &rows[r].values[c], sizeof(bits));
+                AppendLittleEndian(buffer, bits);
+            }
+        }
+    }
+
+private:
+    // APPEND LITTLE ENDIAN
+    // Appends "value" to "buffer" least significant byte first
+    template <typename T>
+    static void AppendLittleEndian(string& buffer, T value) {
+        for (size_t i = 0; i < sizeof(T); i++)
+            buffer += (char)(uint8_t)(value >> (8 * i));
+    }
+};
+
+// CREATE
+inline Results_Module* Results_Module::Create(const string& format) {
+    if (format == "csv")
+        return new CsvResults_Module;
+    if (format == "jsonl")
+        return new JsonResults_Module;
+    if (format == "bin")
+        return new ColumnarResults_Module;
+    return NULL;
+}
+
+#endif // RR_RESULTS_MODULE_H_
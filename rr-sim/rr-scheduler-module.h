@@ -2,39 +2,54 @@
 #define RR_SCHEDULER_MODULE_H_
 
 #include <cstdlib>
+#include <cmath>
+#include <cassert>
 using namespace std;
 
 #include "rr-pcb-module.h"
 #include "rr-queue-module.h"
 #include "rr-cpu-module.h"
+#include "rr-stats-module.h"
+#include "rr-jobtable-module.h"
+#include "rr-source-module.h"
+#include "rr-profile-module.h"
+#include "rr-timeline-module.h"
 
 class Scheduler_Module : public PCB_Module {
 protected:
-    // the scheduler needs to know of all the queues (dealing with scheduling) and the
-    // CPU in order to dispatch jobs on it
+    // the scheduler needs to know of the ready queue, where processes arrive from,
+    // where their jobs live and the CPU in order to dispatch jobs on it
     Queue_Module* readyQ;       // points to the ready queue
-    Queue_Module* arrivalsQ;    // points to the arrivals queue
-    Queue_Module* doneQ;        // points to the done queue
+    Source_Module* arrivals;    // points to the source of arriving processes
+    JobTable_Module* jobs;      // holds the jobs of the processes in the system
+    Stats_Module* stats;        // records processes as they terminate
     CPU_Module* cpu;            // points to the CPU
-    int readyQ_length_sum;      // sum of the length of the ready queue during dispatch
-    int timesChecked;           // amount of times ready queue was checked
+    Timeline_Module* timeline;  // records the run's events (NULL if not traced)
+    unsigned int completed;     // amount of processes that terminated
+    long long readyQ_length_sum;    // sum of the length of the ready queue during dispatch
+    long long timesChecked;         // amount of times ready queue was checked
+    
+    // Allows snapshots to save and restore this class
+    friend class Checkpoint_Module;
     
 public:
     // CONSTRUCTOR - SCHEDULER MODULE
-    Scheduler_Module(Queue_Module* ready_queue, Queue_Module* arrivals_queue,
-                        Queue_Module* done_queue, CPU_Module* processor,
-                        float overhead = 0.0f) : PCB_Module (9032, 0.0f, overhead)
+    Scheduler_Module(Queue_Module* ready_queue, Source_Module* arrivals_source,
+                        JobTable_Module* job_table, Stats_Module* done_stats,
+                        CPU_Module* processor, float overhead = 0.0f)
+                        : PCB_Module (9032, 0.0f, overhead)
     {
-        if (ready_queue == NULL || arrivals_queue == NULL || 
-            arrivals_queue == NULL || done_queue == NULL || processor == NULL) {
-            cerr << "Something was NULL\n";
-            exit (1);
-        }
+        // the parts are wired together by Simulation_Module (never missing)
+        assert(ready_queue != NULL && arrivals_source != NULL && job_table != NULL &&
+                done_stats != NULL && processor != NULL);
         readyQ = ready_queue;
-        arrivalsQ = arrivals_queue;
-        doneQ = done_queue;
+        arrivals = arrivals_source;
+        jobs = job_table;
+        stats = done_stats;
         cpu = processor;
+        timeline = NULL;
         ChangeState(PCB_Module::PS_READY, cpu->cpu_time);
+        completed = 0;
         readyQ_length_sum = 0;
         timesChecked = 0;
     }
@@ -42,14 +57,51 @@ public:
     // DE-CONSTRUCTOR - SCHEDULER MODULE
     ~Scheduler_Module () {
         readyQ = NULL;
-        arrivalsQ = NULL;
-        doneQ = NULL;
+        arrivals = NULL;
+        jobs = NULL;
+        stats = NULL;
         cpu = NULL;
+        timeline = NULL;
+    }
+    
+    // RESET
+    // Puts the scheduler back in its initial state with a (new) overhead
+    void Reset(float overhead) {
+        serviceTime = overhead;
+        timeLeft = overhead;
+        startTime = 0.0f;
+        endTime = 0.0f;
+        state = PCB_Module::PS_NULL;
+        ChangeState(PCB_Module::PS_READY, cpu->cpu_time);
+        completed = 0;
+        readyQ_length_sum = 0;
+        timesChecked = 0;
+    }
+    
+    // SET OVERHEAD
+    // Changes the scheduler overhead from the next scheduler run on
+    void SetOverhead(float overhead) {
+        serviceTime = overhead;
+        timeLeft = overhead;
+    }
+    
+    // SET ARRIVALS
+    // Makes "arrivals_source" the source of arriving processes
+    void SetArrivals(Source_Module* arrivals_source) {
+        if (arrivals_source != NULL)
+            arrivals = arrivals_source;
+    }
+    
+    // SET TIMELINE
+    // Makes the scheduler record the run's events in "events" (NULL stops it)
+    void SetTimeline(Timeline_Module* events) {
+        timeline = events;
     }
     
     // DISPATCH NEXT PROCESS
     // Looks in the ready queue and pops off the next process to execute
     void DispatchNextProcess() {
+        Profile_Timer timer(PP_DISPATCH);
         // 1. check if the ready queue is empty
         // 1.A. if it is not:
         if (!readyQ->Empty()) {
@@ -57,57 +109,120 @@ public:
             readyQ_length_sum += readyQ->Length();
             // increment (by one) the amount of times checked (avg length calculation)
             timesChecked++;
+            Profile_Module::Count(PC_CONTEXT_SWITCHES);
             // dequeue a process and save it to the CPU (it will be loaded automatically)
             cpu->saved_process = readyQ->Dequeue();
             // change the process's state to running and log the CPU time
-            cpu->saved_process->ChangeState(PCB_Module::PS_RUNNING, cpu->cpu_time);
+            jobs->ChangeState(cpu->saved_process, PCB_Module::PS_RUNNING, cpu->cpu_time);
+            if (timeline != NULL)
+                timeline->Record(Timeline_Record::TL_DISPATCH, cpu->cpu_time,
+                                    jobs->GetProcessId(cpu->saved_process));
         // 1.B. if it is:
         } else {
-            cpu->saved_process = NULL;
+            cpu->saved_process = JobTable_Module::NO_JOB;
+            if (timeline != NULL)
+                timeline->Record(Timeline_Record::TL_IDLE, cpu->cpu_time);
         }
     }
     
     // EVALUATE SAVED PROCESS
     // Evaluates the saved process (figures out what to do with it)
     void EvaluateSavedProcess() {
+        Profile_Timer timer(PP_EVALUATE);
         // if the CPU is interrupted
         if (cpu->Interrupted()) {
             // get current cpu time
-            float cputime = cpu->cpu_time;
+            double cputime = cpu->cpu_time;
+            uint32_t process = cpu->saved_process;
             // if the process has time remaining, add it back to the ready queue
-            if (cpu->saved_process->GetTimeRemaining() > 0.0f) {
-                cpu->saved_process->ChangeState(PCB_Module::PS_READY, cputime);
-                readyQ->Enqueue(cpu->saved_process);
-            // else it has finished execution, add it to the done queue
+            if (jobs->GetTimeRemaining(process) > 0.0f) {
+                jobs->ChangeState(process, PCB_Module::PS_READY, cputime);
+                readyQ->Enqueue(process);
+                if (timeline != NULL)
+                    timeline->Record(Timeline_Record::TL_PREEMPT, cputime,
+                                        jobs->GetProcessId(process));
+            // else it has finished execution, record it and retire it (its slot
+            // goes back to the job table)
             } else {
-                cpu->saved_process->ChangeState(PCB_Module::PS_TERMINATED, cputime);
-                doneQ->Enqueue(cpu->saved_process);
-                // if the simulation is done, subtract the scheduler overhead from the
-                // the cpu time because the overhead is added at the end making the cpu
-                // time longer than it should be (1 overhead longer)
-                if (doneQ->Length() == arrivalsQ->MaxLength())
+                jobs->ChangeState(process, PCB_Module::PS_TERMINATED, cputime);
+                if (timeline != NULL)
+                    timeline->Record(Timeline_Record::TL_COMPLETE, cputime,
+                                        jobs->GetProcessId(process));
+                stats->Record(*jobs, process, cputime);
+                jobs->Release(process);
+                completed++;
+                // if the simulation is done (no process left anywhere), subtract the
+                // scheduler overhead from the the cpu time because the overhead is
+                // added at the end making the cpu time longer than it should be
+                // (1 overhead longer); processes beyond the horizon still count
+                if (readyQ->Empty() && arrivals->Peek() == NULL &&
+                        arrivals->Horizon() == HUGE_VALF)
                     cpu->cpu_time -= GetOverhead();
             }
-            cpu->saved_process = NULL;
+            cpu->saved_process = JobTable_Module::NO_JOB;
         }
     }
     
     // CHECK FOR NEW PROCESSES
-    // Looks in the arrivals queue for processes whose arrival times are 
-    // less than or equal to the current CPU time.
+    // Admits the arriving processes whose arrival times are less than or equal to
+    // the current CPU time.
     int CheckForNewProcesses() {
-        int size = readyQ->Length(), amountFound = 0;
-        float cputime = cpu->cpu_time;
-        while (!arrivalsQ->Empty() && arrivalsQ->Front().GetArrivalTime() <= cputime) {
-            PCB_Module* tmp = arrivalsQ->Dequeue();
-            tmp->ChangeState(PCB_Module::PS_READY, cputime);
-            readyQ->Enqueue(tmp);
-            tmp = NULL;
+        Profile_Timer timer(PP_CHECK_ARRIVALS);
+        int amountFound = 0;
+        double cputime = cpu->cpu_time;
+        const Process_t* next;
+        while ((next = arrivals->Peek()) != NULL && next->arrivalTime <= cputime) {
+            AdmitNextProcess();
+            amountFound++;
         }
-        amountFound = readyQ->Length() - size;
         return amountFound;
     }
     
+    // ARRIVALS PENDING
+    // Returns true if more processes will arrive
+    bool ArrivalsPending() {
+        return (arrivals->Peek() != NULL);
+    }
+    
+    // NEXT ARRIVAL TIME
+    // Returns the arrival time of the next process to arrive (or, if none is known,
+    // the arrivals' horizon: infinity unless the trace is still growing)
+    float NextArrivalTime() {
+        const Process_t* next = arrivals->Peek();
+        return (next == NULL) ? arrivals->Horizon() : next->arrivalTime;
+    }
+    
+    // ARRIVAL HORIZON
+    // Returns the time from which on unknown processes may still arrive (infinity
+    // unless the arrivals follow a growing trace)
+    float ArrivalHorizon() {
+        return arrivals->Horizon();
+    }
+    
+    // RUN LENGTH
+    // Returns how far a scheduler run advances the CPU clock (its overhead, capped
+    // at one time quantum as every execution is)
+    float RunLength() {
+        return (timeLeft >= cpu->time_quantum) ? cpu->time_quantum : timeLeft;
+    }
+    
+    // ADMIT NEXT PROCESS
+    // Adds the next arriving process to the job table and the ready queue
+    void AdmitNextProcess() {
+        const Process_t* next = arrivals->Peek();
+        if (next == NULL)
+            return;
+        uint32_t tmp = jobs->Allocate(next->processId, next->arrivalTime,
+                                        next->serviceTime);
+        if (timeline != NULL)
+            timeline->Record(Timeline_Record::TL_ARRIVAL, next->arrivalTime,
+                                next->processId);
+        arrivals->Pop();
+        Profile_Module::Count(PC_ARRIVALS);
+        jobs->ChangeState(tmp, PCB_Module::PS_READY, cpu->cpu_time);
+        readyQ->Enqueue(tmp);
+    }
+    
     // FIRE
     // Executes the scheduler, searches for additional processes that have "recently
     // been submitted" (while the saved process was executing), and performs a
@@ -120,6 +235,66 @@ public:
         return timeLeft;
     }
     
+    // FAST FORWARD
+    // Advances the simulation over whole quanta while nothing "interesting" can
+    // happen: the running process and every process in the ready queue have more
+    // than one quantum left and the next arrival is later than the end of the
+    // scheduler run that follows the quantum. Each skipped quantum has exactly the
+    // effect of cpu->Execute() followed by cpu->Interrupt(this) (same clock
+    // additions in the same order, same ready queue rotation and length sums), so
+    // the results match step-by-step execution bit for bit; it just avoids the
+    // interrupt, arrival polling and evaluation work. Returns the quanta skipped.
+    unsigned long FastForward() {
+        if (!cpu->Busy() || cpu->Interrupted())
+            return 0;
+        Profile_Timer timer(PP_FAST_FORWARD);
+        const float tq = cpu->time_quantum;
+        // the scheduler runs for its overhead, capped at one quantum (see Execute)
+        const float overheadStep = RunLength();
+        const float nextArrival = NextArrivalTime();
+        const bool alone = readyQ->Empty();
+        unsigned long quanta = 0;
+        uint32_t process = cpu->curr_process;
+        double cputime = cpu->cpu_time;
+        while (jobs->GetTimeRemaining(process) > tq) {
+            // the clock after the quantum and the scheduler run that follows it
+            double next = cputime + tq;
+            next += overheadStep;
+            // an arrival would be picked up by that scheduler run
+            if (nextArrival <= next)
+                break;
+            cputime = next;
+            uint32_t preempted = process;
+            jobs->Fire(process, tq);
+            quanta++;
+            // the context switch: with a single process it simply runs again,
+            // otherwise the process goes to the back of the ready queue
+            if (alone) {
+                readyQ_length_sum += 1;
+                timesChecked++;
+                jobs->ChangeState(process, PCB_Module::PS_READY, cputime);
+            } else {
+                jobs->ChangeState(process, PCB_Module::PS_READY, cputime);
+                readyQ->Enqueue(process);
+                readyQ_length_sum += readyQ->Length();
+                timesChecked++;
+                process = readyQ->Dequeue();
+            }
+            jobs->ChangeState(process, PCB_Module::PS_RUNNING, cputime);
+            if (timeline != NULL) {
+                timeline->Record(Timeline_Record::TL_PREEMPT, cputime,
+                                    jobs->GetProcessId(preempted));
+                timeline->Record(Timeline_Record::TL_DISPATCH, cputime,
+                                    jobs->GetProcessId(process));
+            }
+        }
+        cpu->cpu_time = cputime;
+        cpu->curr_process = process;
+        Profile_Module::Count(PC_SKIPPED_QUANTA, quanta);
+        Profile_Module::Count(PC_CONTEXT_SWITCHES, quanta);
+        return quanta;
+    }
+    
     // CONTEXT SWITCH
     // Switches execution from the previous process to the new process
     void ContextSwitch() {
@@ -127,16 +302,42 @@ public:
         DispatchNextProcess();
     }
     
+    // TAKE OFF FINAL OVERHEAD
+    // Takes the scheduler run after the last process off the CPU clock, for runs
+    // that never learn that no more processes will arrive (see EvaluateSavedProcess)
+    void TakeOffFinalOverhead() {
+        if (completed > 0)
+            cpu->cpu_time -= GetOverhead();
+    }
+    
     // GET OVERHEAD
     // Returns the scheduler overhead
     float GetOverhead() {
         return GetServiceTime();
     }
     
+    // GET COMPLETED COUNT
+    // Returns the amount of processes that terminated
+    unsigned int GetCompletedCount() {
+        return completed;
+    }
+    
+    // GET DISPATCH COUNT
+    // Returns the amount of processes dispatched (time slices run)
+    unsigned long long GetDispatchCount() {
+        return (unsigned long long)timesChecked;
+    }
+    
+    // GET READY QUEUE LENGTH SUM
+    // Returns the sum of the length of the ready queue at every dispatch
+    long long GetReadyQueueLengthSum() {
+        return readyQ_length_sum;
+    }
+    
     // GET AVG READY QUEUE LENGTH
-    // Returns the average length of the ready queue
+    // Returns the average length of the ready queue (0 if nothing was dispatched)
     float GetAvgReadyQueueLength() {
-        return ((float)readyQ_length_sum / timesChecked);
+        return (timesChecked > 0) ? ((float)readyQ_length_sum / timesChecked) : 0.0f;
     }
 };
 
@@ -0,0 +1,286 @@
+#ifndef RR_SHARD_MODULE_H_
+#define RR_SHARD_MODULE_H_
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <iostream>
+#include <cerrno>
+#include <stdint.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+using namespace std;
+
+#include "rr-sweep-module.h"
+#include "rr-results-module.h"
+
+// What a worker sends back for a cell, followed by the cell's analysis text, its
+// excel text, (if "hasRow") the Result_Row it added to the results and (if
+// "simulated") the cell's own row
+struct Shard_Reply {
+    uint32_t cell;              // index of the cell in the sweep
+    uint32_t analysisLength;    // bytes of analysis text
+    uint32_t excelLength;       // bytes of excel text
+    uint32_t hasRow;            // a Result_Row follows the texts
+    uint32_t simulated;         // the cell was simulated; its row follows
+    uint32_t reserved;          // 0
+};
+
+// Spreads the cells of a sweep across worker processes instead of threads. The
+// coordinator (the calling process) forks the workers once the workload has been
+// loaded, so every worker starts with the trace in memory (shared copy-on-write,
+// or the same mapping of a binary trace) and only cell numbers and their output
+// cross the Unix domain socket each worker is connected by. A worker runs one cell
+// at a time; if it dies, the cell it was running is handed out again (up to
+// MAX_ATTEMPTS times) and a new worker takes its place. The output lands in the
+// sweep's cells exactly as if the cells had run in this process.
+class Shard_Module {
+private:
+    static const int MAX_ATTEMPTS = 3;  // times a cell is handed out before giving up
+
+    // A worker process as the coordinator sees it
+    struct Worker {
+        pid_t pid;      // the process
+        int fd;         // the coordinator's end of its socket
+        int cell;       // the cell it is running (-1 if idle)
+    };
+
+    unsigned int processes;     // the number of workers to run
+
+public:
+    // CONSTRUCTOR - SHARD MODULE
+    Shard_Module(unsigned int workers) {
+        processes = (workers > 0) ? workers : 1;
+    }
+
+    // DE-CONSTRUCTOR - SHARD MODULE
+    ~Shard_Module() { /* no implementation */ }
+
+    // RUN
+    // Runs "task" once for every cell of "sweep" on the worker processes and waits
+    // for all of them; the rows the task adds to "results" (if any) are carried
+    // back too. Returns false if a cell could not be run.
+    bool Run(Sweep_Module& sweep, const Sweep_Module::CellTask_t& task,
+                Results_Module* results) {
+        deque<int> pending;
+        vector<int> attempts(sweep.Cells(), 0);
+        for (int i = 0; i < sweep.Cells(); i++)
+            pending.push_back(i);
+        vector<Worker> workers;
+        int done = 0;
+        bool ok = true;
+        while (done < sweep.Cells()) {
+            // keep the workers up (a worker that died is replaced)
+            while (workers.size() < processes && Idle(workers) < pending.size()) {
+                Worker worker;
+                if (!Spawn(sweep, task, results, workers, worker))
+                    break;
+                workers.push_back(worker);
+            }
+            if (workers.empty()) {
+                cerr << "No worker process could be started\n";
+                for (; !pending.empty(); pending.pop_front(), done++)
+                    Abandon(sweep.Cell(pending.front()));
+                return false;
+            }
+            // hand out cells to the idle workers
+            for (size_t w = 0; w < workers.size() && !pending.empty(); w++) {
+                if (workers[w].cell >= 0)
+                    continue;
+                uint32_t index = (uint32_t)pending.front();
+                pending.pop_front();
+                workers[w].cell = (int)index;
+                attempts[index]++;
+                Send(workers[w].fd, &index, sizeof(index));  // a failure shows as EOF
+            }
+            // wait for a reply (or a worker's death)
+            vector<pollfd> fds(workers.size());
+            for (size_t w = 0; w < workers.size(); w++) {
+                fds[w].fd = workers[w].fd;
+                fds[w].events = POLLIN;
+                fds[w].revents = 0;
+            }
+            if (poll(fds.data(), fds.size(), -1) < 0 && errno != EINTR) {
+                cerr << "Could not wait for the worker processes\n";
+                break;
+            }
+            for (size_t w = workers.size(); w-- > 0; ) {
+                if (fds[w].revents == 0)
+                    continue;
+                Worker& worker = workers[w];
+                if (worker.cell >= 0 && Receive(worker.fd, sweep, results)) {
+                    worker.cell = -1;
+                    done++;
+                    continue;
+                }
+                // the worker died (or broke the protocol): retry its cell elsewhere
+                int cell = worker.cell;
+                Reap(worker);
+                workers.erase(workers.begin() + w);
+                if (cell < 0)
+                    continue;
+                if (attempts[cell] < MAX_ATTEMPTS) {
+                    cerr << "Worker died during simulation #" << sweep.Cell(cell).count
+                         << "; handing it out again\n";
+                    pending.push_front(cell);
+                } else {
+                    Abandon(sweep.Cell(cell));
+                    done++;
+                    ok = false;
+                }
+            }
+        }
+        // closing the sockets ends the workers
+        for (size_t w = 0; w < workers.size(); w++)
+            Reap(workers[w]);
+        return ok && done == sweep.Cells();
+    }
+
+private:
+    // IDLE
+    // Returns the number of workers that are not running a cell
+    static size_t Idle(const vector<Worker>& workers) {
+        size_t idle = 0;
+        for (size_t w = 0; w < workers.size(); w++)
+            idle += (workers[w].cell < 0) ? 1 : 0;
+        return idle;
+    }
+
+    // SPAWN
+    // Starts a worker process connected by a new socket (false if it cannot)
+    static bool Spawn(Sweep_Module& sweep, const Sweep_Module::CellTask_t& task,
+                        Results_Module* results, const vector<Worker>& others,
+                        Worker& worker) {
+        int ends[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, ends) != 0)
+            return false;
+        // nothing buffered may be written twice (by the worker as well)
+        cout.flush();
+        cerr.flush();
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(ends[0]);
+            close(ends[1]);
+            return false;
+        }
+        if (pid == 0) {
+            close(ends[0]);
+            for (size_t w = 0; w < others.size(); w++)
+                close(others[w].fd);
+            WorkerLoop(ends[1], sweep, task, results);
+        }
+        close(ends[1]);
+        worker.pid = pid;
+        worker.fd = ends[0];
+        worker.cell = -1;
+        return true;
+    }
+
+    // WORKER LOOP
+    // Runs the cells the coordinator hands out until it closes the socket (in the
+    // worker process; never returns)
+    static void WorkerLoop(int fd, Sweep_Module& sweep,
+                            const Sweep_Module::CellTask_t& task, Results_Module* results) {
+        uint32_t index;
+        while (ReceiveAll(fd, &index, sizeof(index)) && index < (uint32_t)sweep.Cells()) {
+            Sweep_Cell& cell = sweep.Cell((int)index);
+            cell.analysis.str("");
+            cell.excel.str("");
+            cell.simulated = false;
+            task(cell, 0);
+            Result_Row row;
+            bool hasRow = (results != NULL && results->Take(cell.count, row));
+            string analysis = cell.analysis.str(), excel = cell.excel.str();
+            Shard_Reply reply = { index, (uint32_t)analysis.size(), (uint32_t)excel.size(),
+                                    hasRow ? 1u : 0u, cell.simulated ? 1u : 0u, 0 };
+            string message((const char*)&reply, sizeof(reply));
+            message += analysis;
+            message += excel;
+            if (hasRow)
+                message.append((const char*)&row, sizeof(row));
+            if (cell.simulated)
+                message.append((const char*)&cell.row, sizeof(cell.row));
+            if (!Send(fd, message.data(), message.size()))
+                break;
+        }
+        _exit(0);   // the coordinator's objects are not this process's to clean up
+    }
+
+    // RECEIVE
+    // Reads a worker's reply into its cell (false if the worker died)
+    static bool Receive(int fd, Sweep_Module& sweep, Results_Module* results) {
+        Shard_Reply reply;
+        if (!ReceiveAll(fd, &reply, sizeof(reply)) || reply.cell >= (uint32_t)sweep.Cells())
+            return false;
+        string analysis(reply.analysisLength, '\0'), excel(reply.excelLength, '\0');
+        Result_Row row, own;
+        if (!ReceiveAll(fd, &analysis[0], analysis.size()) ||
+                !ReceiveAll(fd, &excel[0], excel.size()) ||
+                (reply.hasRow && !ReceiveAll(fd, &row, sizeof(row))) ||
+                (reply.simulated && !ReceiveAll(fd, &own, sizeof(own))))
+            return false;
+        Sweep_Cell& cell = sweep.Cell((int)reply.cell);
+        cell.analysis << analysis;
+        cell.excel << excel;
+        cell.simulated = (reply.simulated != 0);
+        if (cell.simulated)
+            cell.row = own;
+        if (reply.hasRow && results != NULL)
+            results->Add(row);
+        return true;
+    }
+
+    // ABANDON
+    // Notes in a cell's output that it could not be run
+    static void Abandon(Sweep_Cell& cell) {
+        cell.analysis << "START SIMULATION #" << cell.count << "\n"
+                      << "(the simulation failed: its worker process died "
+                      << MAX_ATTEMPTS << " times)\n"
+                      << "END SIMULATION [#" << cell.count << "]\n\n\n";
+    }
+
+    // REAP
+    // Closes a worker's socket and waits for it to exit
+    static void Reap(Worker& worker) {
+        close(worker.fd);
+        int status;
+        while (waitpid(worker.pid, &status, 0) < 0 && errno == EINTR)
+            ;
+    }
+
+    // SEND
+    // Writes all of "length" bytes to a socket (false if the other end is gone)
+    static bool Send(int fd, const void* data, size_t length) {
+        const char* bytes = (const char*)data;
+        while (length > 0) {
+            ssize_t n = send(fd, bytes, length, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            bytes += n;
+            length -= (size_t)n;
+        }
+        return true;
+    }
+
+    // RECEIVE ALL
+    // Reads exactly "length" bytes from a socket (false at EOF or on an error)
+    static bool ReceiveAll(int fd, void* data, size_t length) {
+        char* bytes = (char*)data;
+        while (length > 0) {
+            ssize_t n = recv(fd, bytes, length, 0);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            bytes += n;
+            length -= (size_t)n;
+        }
+        return true;
+    }
+};
+
+#endif // RR_SHARD_MODULE_H_
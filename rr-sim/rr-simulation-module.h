@@ -0,0 +1,158 @@
+#ifndef RR_SIMULATION_MODULE_H_
+#define RR_SIMULATION_MODULE_H_
+
+#include "rr-pcb-module.h"
+#include "rr-queue-module.h"
+#include "rr-cpu-module.h"
+#include "rr-scheduler-module.h"
+#include "rr-jobtable-module.h"
+#include "rr-workload-module.h"
+#include "rr-stats-module.h"
+#include "rr-source-module.h"
+#include "rr-event-module.h"
+
+// ==== QUEUE INDICES ================================================================= //
+const int MAX_QUEUES = 1;
+const int READY = 0;
+
+// Everything a single simulation run needs: the ready queue, the CPU, the scheduler,
+// the pending events, the statistics of finished processes and the table its jobs
+// live in. A run is Reset() and reused for the next grid cell, so a worker keeps one
+// of these for its whole life.
+class Simulation_Module {
+private:
+    Queue_Module queue[MAX_QUEUES];     // the ready queue
+    Stats_Module stats;                 // statistics of the finished processes
+    JobTable_Module jobs;               // the jobs of the current run
+    CPU_Module cpu;                     // the CPU (runs the jobs)
+    WorkloadSource_Module replay;       // replays a loaded workload
+    Scheduler_Module scheduler;         // the scheduler (knows the queues and CPU)
+    NextEvent_Module events;            // the pending event
+
+    // snapshots save and restore every part of the run (see Checkpoint_Module)
+    friend class Checkpoint_Module;
+
+    // the scheduler points into this object, so it is never copied
+    Simulation_Module(const Simulation_Module&) = delete;
+    Simulation_Module& operator=(const Simulation_Module&) = delete;
+
+public:
+    // CONSTRUCTOR - SIMULATION MODULE
+    Simulation_Module() : cpu(&jobs), scheduler(&queue[READY], &replay, &jobs, &stats,
+                                                    &cpu) {
+        /* no implementation */
+    }
+
+    // DE-CONSTRUCTOR - SIMULATION MODULE
+    ~Simulation_Module() { /* no implementation */ }
+
+    // RESET
+    // Empties the queues, releases the jobs of the previous run in one shot and
+    // configures the CPU and scheduler for a new (time quantum, overhead) cell
+    void Reset(float timeQuantum, float overhead) {
+        for (int i = 0; i < MAX_QUEUES; i++)
+            queue[i].Reset();
+        jobs.Reset();
+        replay.Reset(NULL);
+        scheduler.SetArrivals(&replay);
+        stats.Reset();
+        events.Reset();
+        cpu.Reset(timeQuantum);
+        scheduler.Reset(overhead);
+    }
+
+    // RETUNE
+    // Changes the (time quantum, overhead) cell of a run in flight, e.g. to branch
+    // a what-if run off a restored snapshot
+    void Retune(float timeQuantum, float overhead) {
+        cpu.SetTimeQuantum(timeQuantum);
+        scheduler.SetOverhead(overhead);
+    }
+
+    // LOAD
+    // Makes the processes of "workload" arrive during the run
+    void Load(const Workload_Module& workload) {
+        replay.Reset(&workload);
+        scheduler.SetArrivals(&replay);
+    }
+
+    // LOAD
+    // Makes processes [first, last) of "workload" arrive during the run (the
+    // processes after them only show as the arrivals' horizon)
+    void Load(const Workload_Module& workload, unsigned int first, unsigned int last) {
+        replay.Reset(&workload, first, last);
+        scheduler.SetArrivals(&replay);
+    }
+
+    // EXTEND
+    // Makes the processes of the loaded workload up to "last" arrive as well (a run
+    // that paused at the horizon of its range continues past it)
+    void Extend(unsigned int last) {
+        replay.SetEnd(last);
+    }
+
+    // LOAD
+    // Makes the processes read from "source" arrive during the run (jobs are only
+    // added as processes arrive, so the run holds just the live processes)
+    void Load(Source_Module& source) {
+        scheduler.SetArrivals(&source);
+    }
+
+    // SET TIMELINE
+    // Records the events of the following runs in "events" (NULL stops it)
+    void SetTimeline(Timeline_Module* events) {
+        scheduler.SetTimeline(events);
+    }
+
+    // JOBS
+    // Returns the table holding the jobs of the run's live processes
+    JobTable_Module& Jobs() {
+        return jobs;
+    }
+
+    // QUEUES
+    // Returns the run's queues (indexed by READY)
+    Queue_Module* Queues() {
+        return queue;
+    }
+
+    // CPU
+    // Returns the run's CPU
+    CPU_Module& Cpu() {
+        return cpu;
+    }
+
+    // STATS
+    // Returns the statistics of the run's finished processes
+    Stats_Module& Stats() {
+        return stats;
+    }
+
+    // EVENTS
+    // Returns the run's pending event
+    NextEvent_Module& Events() {
+        return events;
+    }
+
+    // METRICS
+    // Returns the deliverables of the (finished) run
+    Run_Metrics Metrics() {
+        Run_Metrics metrics;
+        metrics.overhead = scheduler.GetOverhead();
+        metrics.timeQuantum = cpu.GetTimeQuantum();
+        metrics.maxReadyLength = queue[READY].MaxLength();
+        metrics.avgReadyLength = scheduler.GetAvgReadyQueueLength();
+        metrics.cpuTime = cpu.GetCpuTime();
+        metrics.dispatches = scheduler.GetDispatchCount();
+        metrics.stats = &stats;
+        return metrics;
+    }
+
+    // SCHEDULER
+    // Returns the run's scheduler
+    Scheduler_Module* Scheduler() {
+        return &scheduler;
+    }
+};
+
+#endif // RR_SIMULATION_MODULE_H_
@@ -1,169 +1,280 @@
 #include "rr-simulator.h"
 
-ofstream excel_out;
-ofstream analysis_out;
+// RUN ENGINE FOR
+// Runs a cell on the engine specialized for the quantum policy and the overhead
+// (a zero overhead gets the variant without any scheduler run)
+template <class Quantum_Policy>
+Run_Metrics run_engine_for(Source_Module& source, float timeQuantum, float overhead,
+                            Stats_Module& stats) {
+    if (overhead == 0.0f) {
+        Engine_Module<Quantum_Policy, NoOverhead_Policy> engine(&stats);
+        engine.Reset(timeQuantum, overhead);
+        engine.Run(source);
+        return engine.Metrics();
+    }
+    Engine_Module<Quantum_Policy, FixedOverhead_Policy> engine(&stats);
+    engine.Reset(timeQuantum, overhead);
+    engine.Run(source);
+    return engine.Metrics();
+}
 
-int main(int argc, char** argv) {
-    const char* infile;
-    if (argc > 2) {
-        cerr << "Too many arguments... Continuing.\n";
-        infile = argv[1];
-    } else if (argc == 2) {
-        infile = argv[1];
+// RUN ENGINE FROM
+// Runs a cell on the fixed quantum engine of the first of the sweep's time quanta
+// "I" on that it matches (on the variable quantum engine if it matches none)
+template <int I>
+Run_Metrics run_engine_from(Source_Module& source, float timeQuantum, float overhead,
+                            Stats_Module& stats) {
+    if constexpr (I == NUMB_OF_SWEEP_TQS) {
+        return run_engine_for<VariableQuantum_Policy>(source, timeQuantum, overhead, stats);
     } else {
-        infile = "../input/process-list.txt";
-    }
-    // scheduler overhead and cpu time quantum during a given experiment
-    float schedulerOverhead = 0.0f;
-    float cpuTimeQuantum = 0.0f;
-    
-    // list of overheads and time quantum (in seconds)
-    const int NUMB_OF_OVERHEADS = 6;
-    const int NUMB_OF_TQS = 4;
-    const int NUMB_OF_RUNS = NUMB_OF_OVERHEADS + NUMB_OF_TQS;
-    float overheads[NUMB_OF_OVERHEADS] = { 0.0f, 0.005f, 0.01f, 0.015f, 0.02f, 0.025f };
-    float time_quantums[NUMB_OF_TQS] = { 0.05f, 0.1f, 0.25f, 0.5f };
-    int count = 1;
-    
-    // open output files
-    excel_out.open("../output/excel-output.txt");
-    analysis_out.open("../output/analysis-output.txt");
-    // check if the output files are open
-    if (!excel_out.good() || !analysis_out.good()) {
-        cerr << "One of the output files cannot open!\nExiting...\n";
-        exit (EXIT_FAILURE);
+        typedef FixedQuantum_Policy<SWEEP_TQ_MICROSECONDS[I]> Fixed_Policy;
+        if (timeQuantum == Fixed_Policy::QUANTUM)
+            return run_engine_for<Fixed_Policy>(source, timeQuantum, overhead, stats);
+        return run_engine_from<I + 1>(source, timeQuantum, overhead, stats);
     }
-    // performs all of the experiments by running two for loops (a regular and a nested
-    // for loop)
-    for (int tq_i = 0; tq_i < NUMB_OF_TQS; tq_i++) {
-        cpuTimeQuantum = time_quantums[tq_i];
-        for (int overhead_i = 0; overhead_i < NUMB_OF_OVERHEADS; overhead_i++) {
-            analysis_out << "START SIMULATION #" << count << "\n";
-            schedulerOverhead = overheads[overhead_i];
-            Scheduler_Module* scheduler;
-            Queue_Module queue[MAX_QUEUES];
-            CPU_Module cpu(cpuTimeQuantum);
-            scheduler = new Scheduler_Module(&queue[READY], &queue[ARRIVALS],
-                                                &queue[DONE], &cpu, schedulerOverhead);
-            // ==== initialization ==== //
-            readfile(queue[ARRIVALS], infile);
-            // ==== simulation ==== //
-            run_simulator(queue, scheduler, cpu);
-            // ==== do analysis ==== //
-            perform_analysis(queue, cpu, scheduler, count, NUMB_OF_RUNS);
-            delete scheduler;
-            analysis_out << "END SIMULATION [#" << count << "]\n\n\n";
-            count++;
-        }
+}
+
+// RUN ENGINE
+// Simulates one (time quantum, overhead) cell with the compile-time specialized
+// engine; every time quantum of SWEEP_TQ_MICROSECONDS gets an engine with a fixed
+// quantum
+Run_Metrics run_engine(Source_Module& source, float timeQuantum, float overhead,
+                        Stats_Module& stats) {
+    return run_engine_from<0>(source, timeQuantum, overhead, stats);
+}
+
+// RUN SPLIT
+// Simulates one (time quantum, overhead) cell of a loaded workload with the
+// reference simulator, cut at its idle periods into segments that run on the
+// split's threads (see Split_Module); the results are those of a single run
+Run_Metrics run_split(Split_Module& split, const Workload_Module& workload,
+                        float timeQuantum, float overhead, Stats_Module& stats,
+                        bool fastForward) {
+    return split.Run(workload, timeQuantum, overhead, stats, [=](Simulation_Module* run) {
+        run_simulator(run->Scheduler(), run->Cpu(), run->Events(), fastForward);
+    });
+}
+
+// RUN MULTICORE
+// Simulates one (time quantum, overhead) cell of a loaded workload on a system of
+// several CPUs, each running the reference simulator one window at a time (see
+// Multicore_Module)
+Run_Metrics run_multicore(Multicore_Module& system, const Workload_Module& workload,
+                            float timeQuantum, float overhead, Stats_Module& stats,
+                            bool fastForward) {
+    return system.Run(workload, timeQuantum, overhead, stats, [=](Simulation_Module* core) {
+        run_simulator(core->Scheduler(), core->Cpu(), core->Events(), fastForward);
+    });
+}
+
+// RUN BOUNDED
+// Simulates a loaded workload with the reference simulator in CHECKS pieces of the
+// process list: the run pauses at the arrival of the next piece (exactly as a run
+// over a growing trace does) and is abandoned there if its objective can no longer
+// come out below "bound" (see Optimizer_Module::Hopeless). Returns true if the run
+// finished; its deliverables are then those of an ordinary run.
+bool run_bounded(Simulation_Module& run, const Workload_Module& workload,
+                    float timeQuantum, float overhead,
+                    Optimizer_Module::Objective_t objective, double bound,
+                    bool fastForward) {
+    const unsigned int size = workload.Size();
+    const unsigned int piece = max(size / Optimizer_Module::CHECKS, 1u);
+    unsigned int last = min(piece, size);
+    run.Reset(timeQuantum, overhead);
+    run.Load(workload, 0, last);
+    while (true) {
+        run_simulator(run.Scheduler(), run.Cpu(), run.Events(), fastForward);
+        if (last >= size)
+            return true;
+        if (Optimizer_Module::Hopeless(objective, run.Stats(), size, bound))
+            return false;
+        last = (size - last > piece) ? last + piece : size;
+        run.Extend(last);
     }
-    excel_out.close();
-    analysis_out.close();
-    return 0;
 }
 
 // READ FILE
-// Reads the process input file with each processes arrival and service times
-void readfile(Queue_Module& queue, const char* fileStr) {
-    if (fileStr == NULL) {
-        cerr << "The input file absolute location was no specified. Exiting...\n\n";
-        exit (EXIT_FAILURE);
-    }
-    ifstream ifs(const_cast<char *>(fileStr));
-    if (ifs.is_open()) {
-        string line;
-        const char* WHITESPACE = " \t\n";
-        int id = 0;
-        while (ifs.good()) {
-            getline(ifs, line);
-            char* arrival_cstr = strtok(const_cast<char *>(line.c_str()), WHITESPACE);
-            char* service_cstr = strtok(NULL, WHITESPACE);
-            float arrtime = atof(arrival_cstr);
-            float servtime = atof(service_cstr);
-            queue.Enqueue(new PCB_Module (id++, arrtime, servtime));
-        }
-        ifs.close();
-    } else {
-        cerr << "Could not open input file. Exiting...\n\n";
-        exit(EXIT_FAILURE);
+// Reads the process input file (text or binary trace) with each processes arrival
+// and service times (workload.Error() tells why an unreadable file failed, and
+// workload.FirstInvalid() which process a bad workload trips on)
+Sim_Status_t readfile(Workload_Module& workload, const char* fileStr) {
+    if (fileStr == NULL)
+        return SS_NO_INPUT;
+    if (!workload.Load(fileStr))
+        return SS_UNREADABLE_INPUT;
+    if (workload.FirstInvalid() != workload.Size())
+        return SS_BAD_WORKLOAD;
+    return SS_OK;
+}
+
+// SIMULATE
+// The library entry point: simulates an in-memory workload under "config" with the
+// reference simulator and returns the deliverables in "metrics" (their statistics
+// live in "run" until it is used again). The run is reset first, so one run serves
+// any number of calls and stops allocating once its job table has grown to the
+// workload; a caller simulating on several threads keeps one run per thread. An
+// empty workload is simulated too: nothing runs, and every time and average is 0.
+Sim_Status_t simulate(Simulation_Module& run, const Workload_Module& workload,
+                        const Sim_Config& config, Run_Metrics& metrics) {
+    Sim_Status_t status = config.Validate();
+    if (status != SS_OK)
+        return status;
+    if (workload.FirstInvalid() != workload.Size())
+        return SS_BAD_WORKLOAD;
+    run.Reset(config.timeQuantum, config.overhead);
+    run.Load(workload);
+    run_simulator(run.Scheduler(), run.Cpu(), run.Events(), config.fastForward);
+    metrics = run.Metrics();
+    return SS_OK;
+}
+
+// SCHEDULE NEXT EVENT
+// Schedules what happens next: the end of the running process's time slice (it
+// either uses up its quantum or finishes) or, while the CPU idles, the next arrival
+void schedule_next_event(NextEvent_Module& events, Scheduler_Module* scheduler,
+                            CPU_Module& cpu) {
+    if (cpu.Busy()) {
+        events.Schedule(cpu.SliceEnd(), Event_t::EV_SLICE_END);
+    } else if (scheduler->ArrivalsPending()) {
+        events.Schedule(scheduler->NextArrivalTime(), Event_t::EV_ARRIVAL);
     }
 }
 
 // RUN SIMULATOR
-// This function acts as the Round Robin Simulator
-void run_simulator(Queue_Module queue[], Scheduler_Module* scheduler, CPU_Module& cpu) {
-    float cpu_time = cpu.GetCpuTime();
-    const int totalProcessCount = queue[ARRIVALS].Length();
-    // check if the ready and arrivals queues are empty and the cpu's not busy
-        // [yes] break out of loop
-        // [ no] continue with execution loop
-    while (queue[DONE].Length() < totalProcessCount) {
-        // I. check if the ready queue is empty and the cpu's status
-        if (queue[READY].Empty() && !cpu.Busy()) {
-            // I.1. get the first process from the arrivals queue
-            PCB_Module tmp = queue[ARRIVALS].Front();
-            // I.2. fast fwd the cpu's clock to the new process's arrival time
-            cpu_time = cpu.FastForwardClockTo(tmp.GetArrivalTime());
-            // I.3. dequeue the arrival process and enqueue it into the ready queue
-            PCB_Module* ptmp = queue[ARRIVALS].Dequeue();
-            queue[READY].Enqueue(ptmp);
-            ptmp = NULL;
-            // I.4. dispatch the new process to the cpu
-            scheduler->DispatchNextProcess();
-            // I.5. load the new process on the cpu
-            cpu.LoadProcess();
-            // I.4. dequeue it from the ready queue and "place it on the cpu"
+// This function acts as the Round Robin Simulator. It is driven by the pending
+// events: the end of every time slice hands control to the scheduler (through a CPU
+// interrupt), and an arrival only needs an event while the CPU idles (a busy CPU's
+// scheduler picks arrivals up when it runs), so idle time costs nothing. Between
+// events the run may be saved by "checkpoint" (the run continues from wherever the
+// CPU and scheduler are, so it also resumes a restored snapshot or a paused run).
+// While the arrivals follow a growing trace, the run pauses before a scheduler run
+// that would look for arrivals at or after their horizon (they may not be known
+// yet); it is continued by calling this again once the horizon has moved on.
+void run_simulator(Scheduler_Module* scheduler, CPU_Module& cpu,
+                    NextEvent_Module& events, bool fastForward,
+                    Checkpoint_Module* checkpoint) {
+    Event_t event;
+    const float horizon = scheduler->ArrivalHorizon();
+    events.Reset();
+    schedule_next_event(events, scheduler, cpu);
+    // take events until none is pending (the ready queue is empty, the cpu's not
+    // busy and no more processes will arrive)
+    while (events.Next(event)) {
+        // 0. pause at the horizon (the scheduler run that ends the slice checks for
+        //    arrivals once it has run)
+        if (event.type != Event_t::EV_ARRIVAL && horizon != HUGE_VALF) {
+            double checked = event.time;
+            checked += scheduler->RunLength();
+            if (checked >= horizon)
+                break;
+        }
+        switch (event.type) {
+            // I. a process arrives while the cpu idles
+            case Event_t::EV_ARRIVAL:
+                // I.1. fast fwd the cpu's clock to the process's arrival time
+                cpu.FastForwardClockTo(scheduler->NextArrivalTime());
+                // I.2. admit the arriving process into the ready queue
+                scheduler->AdmitNextProcess();
+                // I.3. dispatch the new process to the cpu
+                scheduler->DispatchNextProcess();
+                // I.4. load the new process on the cpu
+                cpu.LoadProcess();
+                break;
+            // II. the running process's time slice is over
+            case Event_t::EV_SLICE_END:
+                // II.1. execute the current process
+                cpu.Execute();
+                // II.2. interrupt signal [time for scheduling duties]
+                cpu.Interrupt(scheduler);
+                break;
         }
-        // II. execute the current process
-        cpu_time = cpu.Execute();
-        // III. interrupt signal [time for scheduling duties then continue execution]
-        cpu_time = cpu.Interrupt(scheduler);
+        // III. skip over the quanta whose outcome is already known (no arrival,
+        //      no process finishing) and schedule what happens next
+        if (fastForward)
+            scheduler->FastForward();
+        schedule_next_event(events, scheduler, cpu);
+        // IV. save the run if a snapshot is due
+        if (checkpoint != NULL)
+            checkpoint->Tick();
     }
 }
 
 // PERFORM ANALYSIS
-// Calculates the deliverables and outputs them to stdin.
-void perform_analysis(Queue_Module queue[], CPU_Module cpu,
-                        Scheduler_Module* scheduler, int count, const int MAX)
+// Outputs the deliverables of a run: the queue/CPU figures and the statistics
+// recorded as each process terminated (SS_BAD_OUTPUT if the excel stream is bad).
+Sim_Status_t perform_analysis(const Run_Metrics& metrics, int count, const int MAX,
+                        ostream& analysis_out, ostream& excel_out)
 {
-    float avgTurnTime = 0.0f, avgWaitTime = 0.0f;
-    const int len = queue[DONE].Length();
-    float turnTime = 0.0f, waitTime = 0.0f;
-    for (int i = 0; i < len; i++) {
-        PCB_Module* tmp = queue[DONE].Dequeue();
-        turnTime = tmp->CompletedExecution() - tmp->GetArrivalTime();
-        waitTime = tmp->BeganExecution() - tmp->GetArrivalTime();
-        avgTurnTime += turnTime;
-        avgWaitTime += waitTime;
-        delete tmp;
-    }
-    avgTurnTime /= len;
-    avgWaitTime /= len;
+    return perform_analysis(Result_Row::From(metrics, count), analysis_out, excel_out);
+}
+
+// PERFORM ANALYSIS
+// Outputs the deliverables of a run from its results row (fresh or cached); the
+// figures the simulators keep as floats are printed as floats
+Sim_Status_t perform_analysis(const Result_Row& row, ostream& analysis_out,
+                                ostream& excel_out)
+{
+    const double* v = row.values;
+    float overhead = (float)v[Result_Row::RC_OVERHEAD];
+    float timeQuantum = (float)v[Result_Row::RC_TIME_QUANTUM];
+    unsigned int maxReadyLength = (unsigned int)v[Result_Row::RC_MAX_READY_LENGTH];
+    float avgReadyLength = (float)v[Result_Row::RC_AVG_READY_LENGTH];
+    double cpuTime = v[Result_Row::RC_CPU_TIME];
+    float avgTurnTime = (float)v[Result_Row::RC_AVG_TURN_AROUND];
+    float avgWaitTime = (float)v[Result_Row::RC_AVG_WAIT];
+    // p50/p95/p99/max of the turn around times, wait times and slowdowns
+    const double* turnTimes = &v[Result_Row::RC_TURN_AROUND_P50];
+    const double* waitTimes = &v[Result_Row::RC_WAIT_P50];
+    const double* slowdowns = &v[Result_Row::RC_SLOWDOWN_P50];
     
     if (analysis_out.good()) {
-        analysis_out << "SCHEDULER OVERHEAD = " << scheduler->GetOverhead() << " secs\n";
-        analysis_out << "CPU ROUND ROBIN TQ = " << cpu.GetTimeQuantum() << " secs\n";
+        analysis_out << "SCHEDULER OVERHEAD = " << overhead << " secs\n";
+        analysis_out << "CPU ROUND ROBIN TQ = " << timeQuantum << " secs\n";
         analysis_out << "Analysis:\n";
-        analysis_out << "\tREADY queue max length = " << queue[READY].MaxLength() << endl;
+        analysis_out << "\tREADY queue max length = " << maxReadyLength << "\n";
         analysis_out << "\tAvg READY queue length = " 
-                    << scheduler->GetAvgReadyQueueLength() << endl;
-        analysis_out << "\tTOTAL CPU Sim. Time = " << cpu.GetCpuTime() << " secs\n";
+                    << avgReadyLength << "\n";
+        analysis_out << "\tTOTAL CPU Sim. Time = " << cpuTime << " secs\n";
         analysis_out << "\tAverage Turn Around Time = " << avgTurnTime << " secs\n";
         analysis_out << "\tAverage Wait Time = " << avgWaitTime << " secs\n";
+        analysis_out << "\tTurn Around Time p50/p95/p99/max = "
+                    << turnTimes[0] << " / " << turnTimes[1]
+                    << " / " << turnTimes[2] << " / " << turnTimes[3]
+                    << " secs\n";
+        analysis_out << "\tWait Time p50/p95/p99/max = "
+                    << waitTimes[0] << " / " << waitTimes[1]
+                    << " / " << waitTimes[2] << " / " << waitTimes[3]
+                    << " secs\n";
+        analysis_out << "\tSlowdown p50/p95/p99/max = "
+                    << slowdowns[0] << " / " << slowdowns[1]
+                    << " / " << slowdowns[2] << " / " << slowdowns[3]
+                    << "\n";
     }
     
     if (excel_out.good()) {
-        if (count == 1) {
+        if (v[Result_Row::RC_SIMULATION] == 1) {
             excel_out << "SCHEDULER OVERHEAD\tCPU ROUND ROBIN TQ"
                         << "\tREADY queue max length\tAvg Ready queue length"
                         << "\tTOTAL CPU Sim. Time\tAverage Turn Around Time"
-                        << "\tAverage Wait Time\n";
+                        << "\tAverage Wait Time\tp50 Turn Around Time"
+                        << "\tp95 Turn Around Time\tp99 Turn Around Time"
+                        << "\tMax Turn Around Time\tp50 Wait Time\tp95 Wait Time"
+                        << "\tp99 Wait Time\tMax Wait Time\tp50 Slowdown"
+                        << "\tp95 Slowdown\tp99 Slowdown\tMax Slowdown\n";
+        }
+        excel_out << overhead << "\t" << timeQuantum << "\t"
+            << maxReadyLength << "\t" << avgReadyLength 
+            << "\t" << cpuTime << "\t" << avgTurnTime
+            << "\t" << avgWaitTime;
+        const double* percentiles[] = { turnTimes, waitTimes, slowdowns };
+        for (int i = 0; i < 3; i++) {
+            excel_out << "\t" << percentiles[i][0]
+                << "\t" << percentiles[i][1]
+                << "\t" << percentiles[i][2] << "\t" << percentiles[i][3];
         }
-        excel_out << scheduler->GetOverhead() << "\t" << cpu.GetTimeQuantum() << "\t"
-            << queue[READY].MaxLength() << "\t" << scheduler->GetAvgReadyQueueLength() 
-            << "\t" << cpu.GetCpuTime() << "\t" << avgTurnTime
-            << "\t" << avgWaitTime << endl;
+        excel_out << "\n";
     } else {
-        cerr << "Could not open output file. Exiting...\n\n";
-        exit(EXIT_FAILURE);
+        return SS_BAD_OUTPUT;
     }
-}
\ No newline at end of file
+    return SS_OK;
+}
@@ -2,6 +2,7 @@
 #define RR_SIMULATOR_H_
 
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -12,16 +13,43 @@ using namespace std;
 #include "rr-pcb-module.h"
 #include "rr-scheduler-module.h"
 #include "rr-cpu-module.h"
+#include "rr-sweep-module.h"
+#include "rr-workload-module.h"
+#include "rr-simulation-module.h"
+#include "rr-engine-module.h"
+#include "rr-generator-module.h"
+#include "rr-results-module.h"
+#include "rr-checkpoint-module.h"
+#include "rr-tail-module.h"
+#include "rr-shard-module.h"
+#include "rr-split-module.h"
+#include "rr-multicore-module.h"
+#include "rr-config-module.h"
+#include "rr-cache-module.h"
+#include "rr-optimizer-module.h"
 
-// ==== GLOBAL VARIABLES ============================================================== //
-const int MAX_QUEUES = 3;
-const int ARRIVALS = 0;
-const int READY = 1;
-const int DONE = 2;
+// ==== SWEEP GRID ==================================================================== //
+// The time quanta of the sweep, in microseconds so that run_engine() can give each
+// of them an engine with a fixed quantum (see FixedQuantum_Policy)
+constexpr unsigned int SWEEP_TQ_MICROSECONDS[] = { 50000, 100000, 250000, 500000 };
+constexpr int NUMB_OF_SWEEP_TQS = (int)(sizeof(SWEEP_TQ_MICROSECONDS) /
+                                        sizeof(SWEEP_TQ_MICROSECONDS[0]));
 
 // ==== FUNCTION PROTOTYPES =========================================================== //
-void readfile(Queue_Module&, const char*);
-void run_simulator(Queue_Module[], Scheduler_Module*, CPU_Module&);
-void perform_analysis(Queue_Module[], CPU_Module, Scheduler_Module*, int, const int);
+Sim_Status_t readfile(Workload_Module&, const char*);
+Sim_Status_t simulate(Simulation_Module&, const Workload_Module&, const Sim_Config&,
+                        Run_Metrics&);
+void schedule_next_event(NextEvent_Module&, Scheduler_Module*, CPU_Module&);
+void run_simulator(Scheduler_Module*, CPU_Module&, NextEvent_Module&, bool = true,
+                    Checkpoint_Module* = NULL);
+Run_Metrics run_engine(Source_Module&, float, float, Stats_Module&);
+Run_Metrics run_split(Split_Module&, const Workload_Module&, float, float, Stats_Module&,
+                        bool = true);
+Run_Metrics run_multicore(Multicore_Module&, const Workload_Module&, float, float,
+                            Stats_Module&, bool = true);
+bool run_bounded(Simulation_Module&, const Workload_Module&, float, float,
+                    Optimizer_Module::Objective_t, double, bool = true);
+Sim_Status_t perform_analysis(const Run_Metrics&, int, const int, ostream&, ostream&);
+Sim_Status_t perform_analysis(const Result_Row&, ostream&, ostream&);
 
 #endif // RR_SIMULATOR_H_
\ No newline at end of file
@@ -0,0 +1,412 @@
+#ifndef RR_SOURCE_MODULE_H_
+#define RR_SOURCE_MODULE_H_
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <cmath>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+using namespace std;
+
+#include "rr-workload-module.h"
+#include "rr-config-module.h"
+
+// A process as it is submitted to the system
+struct Process_t {
+    unsigned int processId;     // process ID
+    float arrivalTime;          // arrival time [CPU clock]
+    float serviceTime;          // amount of time this process will need to execute
+};
+
+// Where the scheduler takes arriving processes from. Processes come out in arrival
+// order, one at a time, so a run only ever holds the processes that are live.
+class Source_Module {
+public:
+    // DE-CONSTRUCTOR - SOURCE MODULE
+    virtual ~Source_Module() { /* no implementation */ }
+
+    // PEEK
+    // Returns the next process to arrive (NULL once the source is exhausted)
+    virtual const Process_t* Peek() = 0;
+
+    // POP
+    // Consumes the process returned by Peek()
+    virtual void Pop() = 0;
+
+    // HORIZON
+    // Returns the time from which on processes may still turn up that Peek() cannot
+    // see yet (a source following a growing trace); infinity once the source knows
+    // every process it will hand out
+    virtual float Horizon() {
+        return HUGE_VALF;
+    }
+};
+
+// Hands out the processes of an (already loaded) workload, or of a range of it
+class WorkloadSource_Module : public Source_Module {
+private:
+    const Workload_Module* workload;    // the workload being replayed
+    unsigned int position;              // index of the next process
+    unsigned int end;                   // index of the process after the last one
+    Process_t current;                  // the process returned by Peek()
+
+    // snapshots save and restore this class (see Checkpoint_Module)
+    friend class Checkpoint_Module;
+
+public:
+    // CONSTRUCTOR - WORKLOAD SOURCE MODULE
+    WorkloadSource_Module(const Workload_Module* source = NULL) {
+        Reset(source);
+    }
+
+    // RESET
+    // Starts replaying "source" from its first process
+    void Reset(const Workload_Module* source) {
+        Reset(source, 0, (source == NULL) ? 0 : source->Size());
+    }
+
+    // RESET
+    // Starts replaying processes [first, last) of "source"; the processes after
+    // them are announced by the horizon
+    void Reset(const Workload_Module* source, unsigned int first, unsigned int last) {
+        workload = source;
+        position = first;
+        end = last;
+    }
+
+    // SET END
+    // Moves the end of the range to "last" (the replay continues where it is)
+    void SetEnd(unsigned int last) {
+        end = last;
+    }
+
+    // POSITION
+    // Returns the index of the next process to be handed out
+    unsigned int Position() const {
+        return position;
+    }
+
+    // PEEK
+    // Returns the next process to arrive (NULL once the workload is exhausted)
+    virtual const Process_t* Peek() {
+        if (workload == NULL || position >= end)
+            return NULL;
+        current.processId = position;
+        current.arrivalTime = workload->GetArrivalTime(position);
+        current.serviceTime = workload->GetServiceTime(position);
+        return &current;
+    }
+
+    // POP
+    // Consumes the process returned by Peek()
+    virtual void Pop() {
+        position++;
+    }
+
+    // HORIZON
+    // Returns the arrival time of the first process after the range (infinity if
+    // the range runs to the end of the workload)
+    virtual float Horizon() {
+        if (workload == NULL || end >= workload->Size())
+            return HUGE_VALF;
+        return workload->GetArrivalTime(end);
+    }
+};
+
+// Reads a process list (text or binary trace) on a background thread while the
+// simulation runs. The reader fills a bounded number of blocks ahead of the
+// simulation and blocks are recycled, so memory use does not depend on the size
+// of the file. The processes are checked as a loaded workload's are (see
+// Workload_Module::FirstInvalid); the source ends at the last good one and the
+// reason is kept for Status() and Error().
+class StreamSource_Module : public Source_Module {
+private:
+    static const size_t BLOCK_SIZE = 65536;     // processes per block
+    static const size_t BLOCKS = 4;             // blocks in flight
+
+    struct Block {
+        vector<Process_t> processes;    // the processes read into this block
+    };
+
+    string fileName;                // the file being read
+    thread reader;                  // the background reader
+    mutex lock;                     // guards the block lists and flags below
+    condition_variable filled;      // signalled when a block is filled (or at EOF)
+    condition_variable emptied;     // signalled when a block is handed back
+    deque<Block*> full;             // blocks waiting to be consumed (in order)
+    vector<Block*> spare;           // blocks waiting to be filled
+    bool finished;                  // the reader reached the end of the file
+    bool stopping;                  // the source is being destroyed
+    Sim_Status_t status;            // how reading the file ended
+    string error;                   // what went wrong (empty if nothing did)
+    Block* current;                 // the block being consumed
+    size_t position;                // index of the next process in "current"
+
+    // the reader thread points at this object, so it is never copied
+    StreamSource_Module(const StreamSource_Module&) = delete;
+    StreamSource_Module& operator=(const StreamSource_Module&) = delete;
+
+public:
+    // CONSTRUCTOR - STREAM SOURCE MODULE
+    // Starts reading "fileStr" in the background
+    StreamSource_Module(const char* fileStr) : fileName(fileStr) {
+        finished = false;
+        stopping = false;
+        status = SS_OK;
+        current = NULL;
+        position = 0;
+        for (size_t i = 0; i < BLOCKS; i++) {
+            spare.push_back(new Block);
+            spare.back()->processes.reserve(BLOCK_SIZE);
+        }
+        reader = thread(&StreamSource_Module::ReaderLoop, this);
+    }
+
+    // DE-CONSTRUCTOR - STREAM SOURCE MODULE
+    virtual ~StreamSource_Module() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        emptied.notify_all();
+        reader.join();
+        delete current;
+        for (size_t i = 0; i < full.size(); i++)
+            delete full[i];
+        for (size_t i = 0; i < spare.size(); i++)
+            delete spare[i];
+    }
+
+    // STATUS
+    // Returns SS_UNREADABLE_INPUT if the file could not be read or parsed, and
+    // SS_BAD_WORKLOAD if a process cannot be simulated (the source then ends
+    // early, at the last good process); SS_OK otherwise
+    Sim_Status_t Status() {
+        lock_guard<mutex> guard(lock);
+        return status;
+    }
+
+    // ERROR
+    // Returns what went wrong (empty if nothing did)
+    string Error() {
+        lock_guard<mutex> guard(lock);
+        return error;
+    }
+
+    // PEEK
+    // Returns the next process to arrive, waiting for the reader if it is behind
+    // (NULL once the file is exhausted)
+    virtual const Process_t* Peek() {
+        if (current != NULL && position < current->processes.size())
+            return &current->processes[position];
+        if (!NextBlock())
+            return NULL;
+        return &current->processes[position];
+    }
+
+    // POP
+    // Consumes the process returned by Peek()
+    virtual void Pop() {
+        position++;
+    }
+
+private:
+    // NEXT BLOCK
+    // Hands the consumed block back to the reader and waits for the next one
+    bool NextBlock() {
+        unique_lock<mutex> guard(lock);
+        if (current != NULL) {
+            current->processes.clear();
+            spare.push_back(current);
+            current = NULL;
+            emptied.notify_one();
+        }
+        while (full.empty() && !finished)
+            filled.wait(guard);
+        if (full.empty())
+            return false;
+        current = full.front();
+        full.pop_front();
+        position = 0;
+        return true;
+    }
+
+    // TAKE SPARE BLOCK
+    // Waits for an empty block (NULL if the source is being destroyed)
+    Block* TakeSpareBlock() {
+        unique_lock<mutex> guard(lock);
+        while (spare.empty() && !stopping)
+            emptied.wait(guard);
+        if (stopping)
+            return NULL;
+        Block* block = spare.back();
+        spare.pop_back();
+        return block;
+    }
+
+    // PUBLISH
+    // Queues a filled block for the simulation (or recycles an empty one)
+    void Publish(Block* block) {
+        lock_guard<mutex> guard(lock);
+        if (block->processes.empty())
+            spare.push_back(block);
+        else
+            full.push_back(block);
+        filled.notify_one();
+    }
+
+    // FINISH
+    // Marks the end of the file (and how reading it ended)
+    void Finish(Sim_Status_t result, const string& message) {
+        lock_guard<mutex> guard(lock);
+        finished = true;
+        status = result;
+        error = message;
+        filled.notify_all();
+    }
+
+    // READER LOOP
+    // Reads the file block by block until it is exhausted
+    void ReaderLoop() {
+        int fd = open(fileName.c_str(), O_RDONLY);
+        if (fd < 0) {
+            Finish(SS_UNREADABLE_INPUT, "the file could not be opened");
+            return;
+        }
+        Trace_Header header;
+        ssize_t got = pread(fd, &header, sizeof(header), 0);
+        Sim_Status_t result;
+        string message;
+        if (got == (ssize_t)sizeof(header) &&
+                memcmp(header.magic, RR_TRACE_MAGIC, sizeof(RR_TRACE_MAGIC)) == 0)
+            result = ReadBinary(fd, header, message);
+        else
+            result = ReadText(fd, message);
+        close(fd);
+        Finish(result, message);
+    }
+
+    // INVALID
+    // Returns SS_BAD_WORKLOAD with the process that cannot be simulated
+    static Sim_Status_t Invalid(unsigned int id, string& message) {
+        message = "process #" + to_string(id + 1) + " is not";
+        return SS_BAD_WORKLOAD;
+    }
+
+    // READ BINARY
+    // Streams the two columns of a binary trace (read side by side with pread)
+    Sim_Status_t ReadBinary(int fd, const Trace_Header& header, string& message) {
+        if (header.version != RR_TRACE_VERSION) {
+            message = "malformed binary trace";
+            return SS_UNREADABLE_INPUT;
+        }
+        const off_t arrivals = sizeof(Trace_Header);
+        const off_t services = arrivals + (off_t)(header.count * sizeof(float));
+        vector<float> arr(BLOCK_SIZE), serv(BLOCK_SIZE);
+        uint64_t done = 0;
+        float previous = 0.0f;
+        while (done < header.count) {
+            size_t n = (size_t)min<uint64_t>(BLOCK_SIZE, header.count - done);
+            off_t offset = (off_t)(done * sizeof(float));
+            if (pread(fd, arr.data(), n * sizeof(float), arrivals + offset)
+                    != (ssize_t)(n * sizeof(float)) ||
+                pread(fd, serv.data(), n * sizeof(float), services + offset)
+                    != (ssize_t)(n * sizeof(float))) {
+                message = "truncated binary trace";
+                return SS_UNREADABLE_INPUT;
+            }
+            Block* block = TakeSpareBlock();
+            if (block == NULL)
+                return SS_OK;
+            for (size_t i = 0; i < n; i++) {
+                Process_t process = { (unsigned int)(done + i), arr[i], serv[i] };
+                if (!Workload_Module::ValidProcess(previous, arr[i], serv[i])) {
+                    Publish(block);
+                    return Invalid(process.processId, message);
+                }
+                previous = arr[i];
+                block->processes.push_back(process);
+            }
+            Publish(block);
+            done += n;
+        }
+        return SS_OK;
+    }
+
+    // READ TEXT
+    // Streams a text process list, carrying partial lines over between reads
+    Sim_Status_t ReadText(int fd, string& message) {
+        const size_t CHUNK = 1 << 20;
+        vector<char> buffer(CHUNK * 2);
+        size_t carried = 0;
+        unsigned int line = 1, id = 0;
+        float previous = 0.0f;
+        bool eof = false;
+        Block* block = NULL;
+        while (!eof || carried > 0) {
+            if (!eof) {
+                if (buffer.size() - carried < CHUNK)
+                    buffer.resize(carried + CHUNK);
+                ssize_t n = read(fd, buffer.data() + carried, CHUNK);
+                if (n < 0) {
+                    message = "the file could not be read";
+                    return SS_UNREADABLE_INPUT;
+                }
+                eof = (n == 0);
+                carried += (size_t)n;
+            }
+            // only complete lines are parsed (everything, once at the end of file)
+            const char* begin = buffer.data();
+            const char* end = begin + carried;
+            if (!eof) {
+                while (end > begin && end[-1] != '\n')
+                    end--;
+                if (end == begin)
+                    continue;   // a line longer than the buffer; keep reading
+            }
+            const char* p = begin;
+            float arrtime, servtime;
+            int result;
+            while ((result = Workload_Module::ParseProcess(p, end, line, arrtime,
+                                                            servtime))
+                    == Workload_Module::PARSED) {
+                if (block == NULL && (block = TakeSpareBlock()) == NULL)
+                    return SS_OK;
+                if (!Workload_Module::ValidProcess(previous, arrtime, servtime)) {
+                    Publish(block);
+                    return Invalid(id, message);
+                }
+                previous = arrtime;
+                Process_t process = { id++, arrtime, servtime };
+                block->processes.push_back(process);
+                if (block->processes.size() == BLOCK_SIZE) {
+                    Publish(block);
+                    block = NULL;
+                }
+            }
+            if (result == Workload_Module::MALFORMED) {
+                message = "line " + to_string(line) + ": expected \"arrival service\"";
+                if (block != NULL)
+                    Publish(block);
+                return SS_UNREADABLE_INPUT;
+            }
+            // move the unparsed tail (a partial line) to the front of the buffer
+            size_t used = (size_t)(end - begin);
+            memmove(buffer.data(), buffer.data() + used, carried - used);
+            carried -= used;
+            if (eof)
+                carried = 0;
+        }
+        if (block != NULL)
+            Publish(block);
+        return SS_OK;
+    }
+};
+
+#endif // RR_SOURCE_MODULE_H_
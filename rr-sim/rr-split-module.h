@@ -0,0 +1,213 @@
+#ifndef RR_SPLIT_MODULE_H_
+#define RR_SPLIT_MODULE_H_
+
+#include <vector>
+#include <cmath>
+#include <functional>
+#include <algorithm>
+#include <stdint.h>
+using namespace std;
+
+#include "rr-simulation-module.h"
+#include "rr-threadpool-module.h"
+#include "rr-profile-module.h"
+
+// Simulates one (time quantum, overhead) cell of a loaded workload on several
+// threads at once. Once a single CPU round robin system empties (the ready queue is
+// drained and the CPU idles), nothing but its statistics carries over: from the
+// next arrival on it runs exactly as a run started at that arrival would. The
+// workload is cut at the idle periods a quick pass over the arrival and service
+// times expects (see Plan) and every segment is simulated on its own run from a
+// clean state, replaying only its processes with the first arrival of the next
+// segment as the horizon (so the run neither looks past it nor takes the final
+// scheduler overhead off). A segment whose run stops before it has emptied (the
+// pass guessed wrong) is joined with the next one and simulated again. Once every
+// segment has emptied, the runs are exactly the pieces of one run, so their
+// statistics and queue counters add up to the same results.
+class Split_Module {
+public:
+    // simulates a run that has been loaded with a segment
+    typedef function<void(Simulation_Module*)> SegmentTask_t;
+
+private:
+    static const unsigned int SEGMENTS_PER_WORKER = 4;  // for load balancing
+
+    // a range of the workload [first, last)
+    struct Segment {
+        unsigned int first;
+        unsigned int last;
+    };
+
+    ThreadPool_Module pool;             // the threads the segments run on
+    vector<Simulation_Module*> runs;    // the run of every segment (reused)
+    unsigned int segmentsRun;           // segments simulated for the last cell
+    vector<Profile_Counters> profiles;  // what every thread counted for the cell
+
+    // the runs are owned, so a split is never copied
+    Split_Module(const Split_Module&) = delete;
+    Split_Module& operator=(const Split_Module&) = delete;
+
+public:
+    // CONSTRUCTOR - SPLIT MODULE
+    Split_Module(unsigned int threads = 0) : pool(threads), profiles(pool.Size()) {
+        segmentsRun = 0;
+    }
+
+    // DE-CONSTRUCTOR - SPLIT MODULE
+    ~Split_Module() {
+        for (size_t i = 0; i < runs.size(); i++)
+            delete runs[i];
+    }
+
+    // WORKERS
+    // Returns the number of threads the segments run on
+    unsigned int Workers() const {
+        return pool.Size();
+    }
+
+    // SEGMENTS RUN
+    // Returns the number of segment runs the last cell took (including the runs of
+    // segments that had to be joined)
+    unsigned int SegmentsRun() const {
+        return segmentsRun;
+    }
+
+    // RUN
+    // Simulates "workload" with a time quantum and overhead, running "simulate" on
+    // every segment, and returns the deliverables (the statistics end up in "stats")
+    Run_Metrics Run(const Workload_Module& workload, float timeQuantum, float overhead,
+                    Stats_Module& stats, const SegmentTask_t& simulate) {
+        vector<Segment> segments = Plan(workload, timeQuantum, overhead,
+                                        pool.Size() * SEGMENTS_PER_WORKER);
+        while (runs.size() < segments.size())
+            runs.push_back(new Simulation_Module);
+        vector<bool> pending(segments.size(), true);
+        segmentsRun = 0;
+        while (true) {
+            // 1. simulate the segments not simulated yet
+            for (size_t i = 0; i < segments.size(); i++) {
+                if (!pending[i])
+                    continue;
+                Simulation_Module* run = runs[i];
+                Segment segment = segments[i];
+                Profile_Counters* counted = profiles.data();
+                pool.Submit([=, &workload, &simulate](int worker) {
+                    run->Reset(timeQuantum, overhead);
+                    run->Load(workload, segment.first, segment.last);
+                    simulate(run);
+                    Profile_Module::Take(counted[worker]);
+                });
+                pending[i] = false;
+                segmentsRun++;
+            }
+            pool.Wait();
+            // 2. join every segment that did not empty with the one after it (the
+            //    last segment runs to the end, so it always empties)
+            bool joined = false;
+            for (size_t i = 0; i + 1 < segments.size(); i++) {
+                if (Emptied(runs[i]))
+                    continue;
+                segments[i].last = segments[i + 1].last;
+                segments.erase(segments.begin() + i + 1);
+                pending.erase(pending.begin() + i + 1);
+                // the run of the absorbed segment is kept for later cells
+                runs.push_back(runs[i + 1]);
+                runs.erase(runs.begin() + i + 1);
+                pending[i] = true;
+                joined = true;
+            }
+            if (!joined)
+                break;
+        }
+        // the segments were counted on the pool's threads
+        for (size_t i = 0; i < profiles.size(); i++) {
+            Profile_Module::Add(profiles[i]);
+            profiles[i] = Profile_Counters();
+        }
+        return Merge(segments.size(), timeQuantum, overhead, stats);
+    }
+
+private:
+    // EMPTIED
+    // Returns true if a segment's run ended with the system empty (rather than
+    // pausing at the horizon with processes left)
+    static bool Emptied(Simulation_Module* run) {
+        return !run->Cpu().Busy() && !run->Scheduler()->ArrivalsPending();
+    }
+
+    // MERGE
+    // Adds up the runs of the first "count" segments (in workload order)
+    Run_Metrics Merge(size_t count, float timeQuantum, float overhead,
+                        Stats_Module& stats) {
+        unsigned int maxLength = 0;
+        long long lengthSum = 0;
+        long long dispatches = 0;
+        stats.Reset();
+        for (size_t i = 0; i < count; i++) {
+            Simulation_Module* run = runs[i];
+            maxLength = max(maxLength, run->Queues()[READY].MaxLength());
+            lengthSum += run->Scheduler()->GetReadyQueueLengthSum();
+            dispatches += (long long)run->Scheduler()->GetDispatchCount();
+            stats.Merge(run->Stats());
+        }
+        // computed as Scheduler_Module::GetAvgReadyQueueLength() does
+        Run_Metrics metrics;
+        metrics.overhead = overhead;
+        metrics.timeQuantum = timeQuantum;
+        metrics.maxReadyLength = maxLength;
+        metrics.avgReadyLength = (dispatches > 0) ? ((float)lengthSum / dispatches) : 0.0f;
+        metrics.cpuTime = runs[count - 1]->Cpu().GetCpuTime();
+        metrics.dispatches = (unsigned long long)dispatches;
+        metrics.stats = &stats;
+        return metrics;
+    }
+
+    // PLAN
+    // Cuts the workload into (at most) "count" segments of about the same number of
+    // processes. A cut goes before a process that arrives after the system is
+    // expected to have emptied: the pass adds up every process's time slices and
+    // the scheduler run after each slice in double precision, and wants a margin for
+    // the rounding of the simulation's (double) clock and for a slice more or less
+    // per process (the runs check every cut anyway).
+    static vector<Segment> Plan(const Workload_Module& workload, float timeQuantum,
+                                float overhead, unsigned int count) {
+        const unsigned int size = workload.Size();
+        // the scheduler runs for its overhead, capped at one quantum
+        const double run = (overhead >= timeQuantum) ? timeQuantum : overhead;
+        const double tq = timeQuantum;
+        const double ulp = ldexp(1.0, -52);
+        vector<Segment> segments;
+        Segment segment = { 0, size };
+        double drain = 0.0;         // when the system is expected to empty
+        double slices = 0.0;        // time slices in the current busy period
+        double processes = 0.0;     // processes in the current busy period
+        unsigned int k = 1;
+        for (unsigned int i = 0; i < size; i++) {
+            const double arrival = workload.GetArrivalTime(i);
+            const double service = workload.GetServiceTime(i);
+            if (k < count && i >= (unsigned int)((uint64_t)size * k / count) && i > 0) {
+                double margin = slices * 2.0 * ulp * drain + processes * run + tq;
+                if (drain + margin < arrival) {
+                    segment.last = i;
+                    segments.push_back(segment);
+                    segment.first = i;
+                    k++;
+                }
+            }
+            if (arrival > drain) {
+                drain = arrival;
+                slices = 0.0;
+                processes = 0.0;
+            }
+            double n = (tq > 0.0) ? max(1.0, ceil(service / tq)) : 1.0;
+            drain += service + n * run;
+            slices += n;
+            processes += 1.0;
+        }
+        segment.last = size;
+        segments.push_back(segment);
+        return segments;
+    }
+};
+
+#endif // RR_SPLIT_MODULE_H_
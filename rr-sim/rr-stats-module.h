@@ -0,0 +1,342 @@
+#ifndef RR_STATS_MODULE_H_
+#define RR_STATS_MODULE_H_
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <stdint.h>
+using namespace std;
+
+#include "rr-jobtable-module.h"
+
+// Exact sum of doubles. Every double of magnitude 2^-12 or more is a whole multiple
+// of 2^-64, so it is accumulated exactly as a 128-bit fixed point number with 64
+// fractional bits; smaller magnitudes are rounded to the nearest 2^-64 and those of
+// 2^62 or more are clamped. Each value is converted on its own, so the sum does not
+// depend on the order values are added in, which lets partial sums (per worker,
+// per segment, ...) be merged without changing the result.
+class ExactSum_Module {
+private:
+    __int128 sum;       // the sum in units of 2^-64
+
+    // snapshots save and restore this class (see Checkpoint_Module)
+    friend class Checkpoint_Module;
+
+public:
+    // CONSTRUCTOR - EXACT SUM MODULE
+    ExactSum_Module() {
+        sum = 0;
+    }
+
+    // RESET
+    // Sets the sum back to zero
+    void Reset() {
+        sum = 0;
+    }
+
+    // ADD
+    // Adds "value" to the sum (magnitudes below 2^-12 are rounded to a multiple of
+    // 2^-64, those of 2^62 and up are clamped)
+    void Add(double value) {
+        double scaled = ldexp(value, 64);
+        const double LIMIT = ldexp(1.0, 126);   // 2^62 in units of 2^-64
+        if (scaled >= LIMIT)
+            scaled = LIMIT;
+        else if (scaled <= -LIMIT)
+            scaled = -LIMIT;
+        sum += (__int128)nearbyint(scaled);
+    }
+
+    // MERGE
+    // Adds another sum to this one
+    void Merge(const ExactSum_Module& other) {
+        sum += other.sum;
+    }
+
+    // GET VALUE
+    // Returns the sum (rounded to a double)
+    double GetValue() const {
+        return ldexp((double)sum, -64);
+    }
+};
+
+// HDR-style log-linear histogram of non-negative values. A value is scaled to an
+// integer ("unit" per second, ...) and counted in a bucket whose width is at most
+// 1/2^(SUB_BUCKET_BITS-1) of the value, so percentiles are accurate to ~0.2%.
+// Histograms with the same unit merge by adding their counts.
+class Histogram_Module {
+private:
+    static const int SUB_BUCKET_BITS = 10;
+    static const uint64_t SUB_BUCKETS = 1ull << SUB_BUCKET_BITS;
+    static const uint64_t HALF = SUB_BUCKETS / 2;
+    static const int BUCKETS = (int)(SUB_BUCKETS + (64 - SUB_BUCKET_BITS) * HALF);
+
+    double unit;                // scale applied to values before they are counted
+    vector<uint64_t> counts;    // count per bucket
+    uint64_t total;             // values recorded
+    double minValue;            // smallest value recorded
+    double maxValue;            // largest value recorded
+
+    // snapshots save and restore this class (see Checkpoint_Module)
+    friend class Checkpoint_Module;
+
+public:
+    // CONSTRUCTOR - HISTOGRAM MODULE
+    Histogram_Module(double valueUnit = 1e6) : counts(BUCKETS, 0) {
+        unit = valueUnit;
+        total = 0;
+        minValue = 0.0;
+        maxValue = 0.0;
+    }
+
+    // RESET
+    // Forgets every recorded value
+    void Reset() {
+        if (total != 0)
+            fill(counts.begin(), counts.end(), 0);
+        total = 0;
+        minValue = 0.0;
+        maxValue = 0.0;
+    }
+
+    // RECORD
+    // Counts "value" (negative values count as zero)
+    void Record(double value) {
+        if (!(value > 0.0))
+            value = 0.0;
+        double scaled = value * unit + 0.5;
+        uint64_t v = (scaled >= 1.8e19) ? ~0ull : (uint64_t)scaled;
+        counts[BucketOf(v)]++;
+        if (total == 0 || value < minValue)
+            minValue = value;
+        if (total == 0 || value > maxValue)
+            maxValue = value;
+        total++;
+    }
+
+    // MERGE
+    // Adds the counts of another histogram (recorded with the same unit)
+    void Merge(const Histogram_Module& other) {
+        if (other.total == 0)
+            return;
+        for (int i = 0; i < BUCKETS; i++)
+            counts[i] += other.counts[i];
+        if (total == 0 || other.minValue < minValue)
+            minValue = other.minValue;
+        if (total == 0 || other.maxValue > maxValue)
+            maxValue = other.maxValue;
+        total += other.total;
+    }
+
+    // COUNT
+    // Returns the number of recorded values
+    uint64_t Count() const {
+        return total;
+    }
+
+    // MAX
+    // Returns the largest recorded value
+    double Max() const {
+        return maxValue;
+    }
+
+    // COUNT ABOVE
+    // Returns the number of recorded values certain to be larger than "value" (the
+    // ones counted by buckets that lie entirely above it), so a percentile whose
+    // rank is beyond the values not counted comes out larger than "value"
+    uint64_t CountAbove(double value) const {
+        // a recorded value is at least half a unit below the start of its bucket
+        double least = value * unit + 1.0;
+        uint64_t above = 0;
+        for (int i = BUCKETS - 1; i >= 0 && (double)LowestOf(i) >= least; i--)
+            above += counts[i];
+        return above;
+    }
+
+    // PERCENTILE
+    // Returns the value below which "percent" percent of the recorded values fall
+    // (the upper end of the bucket holding that rank, capped at the max)
+    double Percentile(double percent) const {
+        if (total == 0)
+            return 0.0;
+        uint64_t rank = (uint64_t)ceil(percent / 100.0 * (double)total);
+        if (rank < 1)
+            rank = 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += counts[i];
+            if (seen >= rank) {
+                double value = (double)HighestOf(i) / unit;
+                if (value > maxValue)
+                    value = maxValue;
+                if (value < minValue)
+                    value = minValue;
+                return value;
+            }
+        }
+        return maxValue;
+    }
+
+private:
+    // BUCKET OF
+    // Returns the bucket counting the (scaled) value "v"
+    static int BucketOf(uint64_t v) {
+        if (v < SUB_BUCKETS)
+            return (int)v;
+        int msb = 63 - __builtin_clzll(v);
+        int shift = msb - SUB_BUCKET_BITS + 1;
+        uint64_t top = v >> shift;    // in [HALF, SUB_BUCKETS)
+        return (int)(SUB_BUCKETS + (uint64_t)(shift - 1) * HALF + (top - HALF));
+    }
+
+    // LOWEST OF
+    // Returns the smallest (scaled) value counted by "bucket"
+    static uint64_t LowestOf(int bucket) {
+        if ((uint64_t)bucket < SUB_BUCKETS)
+            return (uint64_t)bucket;
+        uint64_t k = (uint64_t)bucket - SUB_BUCKETS;
+        int shift = (int)(k / HALF) + 1;
+        uint64_t top = k % HALF + HALF;
+        return top << shift;
+    }
+
+    // HIGHEST OF
+    // Returns the largest (scaled) value counted by "bucket"
+    static uint64_t HighestOf(int bucket) {
+        if ((uint64_t)bucket < SUB_BUCKETS)
+            return (uint64_t)bucket;
+        uint64_t k = (uint64_t)bucket - SUB_BUCKETS;
+        int shift = (int)(k / HALF) + 1;
+        uint64_t top = k % HALF + HALF;
+        return ((top + 1) << shift) - 1;
+    }
+};
+
+// Statistics of the processes that finished during a run. Every process is
+// recorded the moment it terminates, so nothing has to be kept around until the
+// end of the run and memory does not grow with the length of the trace.
+class Stats_Module {
+private:
+    uint64_t completed;             // processes recorded
+    ExactSum_Module turnTimeSum;    // sum of the turn around times
+    ExactSum_Module waitTimeSum;    // sum of the wait times
+    Histogram_Module turnTimes;     // turn around time distribution [usecs]
+    Histogram_Module waitTimes;     // wait time distribution [usecs]
+    Histogram_Module slowdowns;     // turn around / service time distribution
+
+    // snapshots save and restore this class (see Checkpoint_Module)
+    friend class Checkpoint_Module;
+
+public:
+    // CONSTRUCTOR - STATS MODULE
+    Stats_Module() : turnTimes(1e6), waitTimes(1e6), slowdowns(1e3) {
+        completed = 0;
+    }
+
+    // RESET
+    // Forgets every recorded process
+    void Reset() {
+        completed = 0;
+        turnTimeSum.Reset();
+        waitTimeSum.Reset();
+        turnTimes.Reset();
+        waitTimes.Reset();
+        slowdowns.Reset();
+    }
+
+    // RECORD
+    // Records job "job" of "jobs", which terminated at (cpu) time "endTime"
+    void Record(const JobTable_Module& jobs, uint32_t job, double endTime) {
+        double turnTime = endTime - jobs.GetArrivalTime(job);
+        double waitTime = jobs.BeganExecution(job) - jobs.GetArrivalTime(job);
+        Record(turnTime, waitTime, jobs.GetServiceTime(job));
+    }
+
+    // RECORD
+    // Records a terminated process given its turn around, wait and service times
+    void Record(double turnTime, double waitTime, float serviceTime) {
+        turnTimeSum.Add(turnTime);
+        waitTimeSum.Add(waitTime);
+        turnTimes.Record(turnTime);
+        waitTimes.Record(waitTime);
+        if (serviceTime > 0.0f)
+            slowdowns.Record(turnTime / serviceTime);
+        completed++;
+    }
+
+    // MERGE
+    // Adds the statistics of another (partial) run to this one
+    void Merge(const Stats_Module& other) {
+        completed += other.completed;
+        turnTimeSum.Merge(other.turnTimeSum);
+        waitTimeSum.Merge(other.waitTimeSum);
+        turnTimes.Merge(other.turnTimes);
+        waitTimes.Merge(other.waitTimes);
+        slowdowns.Merge(other.slowdowns);
+    }
+
+    // COMPLETED
+    // Returns the number of processes recorded
+    uint64_t Completed() const {
+        return completed;
+    }
+
+    // GET AVG TURN AROUND TIME
+    // Returns the average turn around time (0 if no process was recorded)
+    float GetAvgTurnAroundTime() const {
+        if (completed == 0)
+            return 0.0f;
+        return (float)(turnTimeSum.GetValue() / (double)completed);
+    }
+
+    // GET AVG WAIT TIME
+    // Returns the average wait time (0 if no process was recorded)
+    float GetAvgWaitTime() const {
+        if (completed == 0)
+            return 0.0f;
+        return (float)(waitTimeSum.GetValue() / (double)completed);
+    }
+
+    // GET TURN AROUND TIME SUM
+    // Returns the sum of the turn around times recorded so far
+    double GetTurnAroundTimeSum() const {
+        return turnTimeSum.GetValue();
+    }
+
+    // GET WAIT TIME SUM
+    // Returns the sum of the wait times recorded so far
+    double GetWaitTimeSum() const {
+        return waitTimeSum.GetValue();
+    }
+
+    // TURN AROUND TIMES
+    // Returns the turn around time distribution
+    const Histogram_Module& TurnAroundTimes() const {
+        return turnTimes;
+    }
+
+    // WAIT TIMES
+    // Returns the wait time distribution
+    const Histogram_Module& WaitTimes() const {
+        return waitTimes;
+    }
+
+    // SLOWDOWNS
+    // Returns the slowdown (turn around / service time) distribution
+    const Histogram_Module& Slowdowns() const {
+        return slowdowns;
+    }
+};
+
+// The deliverables of one simulation run (one grid cell)
+struct Run_Metrics {
+    float overhead;                 // the scheduler overhead [secs]
+    float timeQuantum;              // the round robin time quantum [secs]
+    unsigned int maxReadyLength;    // the READY queue max length
+    float avgReadyLength;           // the avg READY queue length (at dispatch)
+    double cpuTime;                 // the total CPU (simulated) time [secs]
+    unsigned long long dispatches;  // the amount of dispatches (time slices run)
+    const Stats_Module* stats;      // the statistics of the finished processes
+};
+
+#endif // RR_STATS_MODULE_H_
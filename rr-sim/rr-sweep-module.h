@@ -0,0 +1,109 @@
+#ifndef RR_SWEEP_MODULE_H_
+#define RR_SWEEP_MODULE_H_
+
+#include <vector>
+#include <sstream>
+#include <functional>
+#include <algorithm>
+using namespace std;
+
+#include "rr-threadpool-module.h"
+#include "rr-results-module.h"
+
+// Describes one cell of the (time quantum x overhead) grid along with the output
+// it produced; each cell buffers its own output so workers never share a stream
+struct Sweep_Cell {
+    int count;                  // 1-based simulation number (grid order)
+    float timeQuantum;          // the round robin time quantum of this cell
+    float overhead;             // the scheduler overhead of this cell
+    ostringstream analysis;     // buffered analysis-output text for this cell
+    ostringstream excel;        // buffered excel-output rows for this cell
+    bool simulated;             // the cell was simulated (not found in a cache)
+    Result_Row row;             // its results, if it was simulated
+};
+
+class Sweep_Module {
+public:
+    typedef function<void(Sweep_Cell&, int)> CellTask_t;
+
+private:
+    vector<Sweep_Cell*> cells;  // the grid cells in deterministic (tq, overhead) order
+    ThreadPool_Module pool;     // the workers the cells are spread across
+
+public:
+    // CONSTRUCTOR - SWEEP MODULE
+    // Builds the grid with the time quantum as the outer and the overhead as the
+    // inner dimension (the same order the simulations were always numbered in)
+    Sweep_Module(const float* time_quantums, int numb_of_tqs,
+                 const float* overheads, int numb_of_overheads,
+                 unsigned int threads = 0) : pool(threads)
+    {
+        int count = 1;
+        for (int tq_i = 0; tq_i < numb_of_tqs; tq_i++) {
+            for (int overhead_i = 0; overhead_i < numb_of_overheads; overhead_i++) {
+                Sweep_Cell* cell = new Sweep_Cell;
+                cell->count = count++;
+                cell->timeQuantum = time_quantums[tq_i];
+                cell->overhead = overheads[overhead_i];
+                cell->simulated = false;
+                cells.push_back(cell);
+            }
+        }
+    }
+
+    // DE-CONSTRUCTOR - SWEEP MODULE
+    ~Sweep_Module() {
+        for (size_t i = 0; i < cells.size(); i++)
+            delete cells[i];
+    }
+
+    // WORKERS
+    // Returns the number of workers the grid is spread across
+    unsigned int Workers() const {
+        return pool.Size();
+    }
+
+    // CELLS
+    // Returns the number of grid cells
+    int Cells() const {
+        return (int)cells.size();
+    }
+
+    // CELL
+    // Returns the cell with (0-based) index "index" in grid order
+    Sweep_Cell& Cell(int index) {
+        return *cells[index];
+    }
+
+    // RUN
+    // Runs "task" once for every cell on the thread pool and waits for all of them
+    void Run(const CellTask_t& task) {
+        for (size_t i = 0; i < cells.size(); i++) {
+            Sweep_Cell* cell = cells[i];
+            pool.Submit([cell, &task](int worker) { task(*cell, worker); });
+        }
+        pool.Wait();
+    }
+
+    // CLEAR
+    // Forgets every cell's buffered output (before the cells are run again)
+    void Clear() {
+        for (size_t i = 0; i < cells.size(); i++) {
+            cells[i]->analysis.str("");
+            cells[i]->excel.str("");
+            cells[i]->simulated = false;
+        }
+    }
+
+    // MERGE
+    // Writes every cell's buffered output in grid order, regardless of which worker
+    // finished first
+    void Merge(ostream& analysis_out, ostream& excel_out) const {
+        for (size_t i = 0; i < cells.size(); i++) {
+            analysis_out << cells[i]->analysis.str();
+            excel_out << cells[i]->excel.str();
+        }
+    }
+};
+
+#endif // RR_SWEEP_MODULE_H_
@@ -0,0 +1,215 @@
+#ifndef RR_TAIL_MODULE_H_
+#define RR_TAIL_MODULE_H_
+
+#include <deque>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+using namespace std;
+
+#include "rr-workload-module.h"
+#include "rr-source-module.h"
+
+// Follows a text process list that is still being written to (like "tail -f").
+// Every Poll() parses the complete lines appended since the last one; the
+// processes are kept until every run following the file has admitted them (see
+// Trim), so memory follows the runs rather than the length of the trace. The
+// arrival times are sorted, so the processes not read yet arrive at or after the
+// last one read: that is the horizon the runs can safely be simulated up to.
+class Tail_Module {
+private:
+    static const size_t CHUNK = 1 << 20;    // bytes per read
+
+    string fileName;                // the file being followed
+    int fd;                         // the file
+    deque<Process_t> processes;     // the processes read and not yet trimmed
+    uint64_t first;                 // index (process ID) of processes.front()
+    vector<char> buffer;            // the partial line carried over between polls
+    unsigned int line;              // the line being parsed
+    float lastArrival;              // arrival time of the last process read
+    bool closed;                    // no more processes will be read
+    bool failed;                    // the file could not be read or parsed
+
+    // the file descriptor is owned, so a tail is never copied
+    Tail_Module(const Tail_Module&) = delete;
+    Tail_Module& operator=(const Tail_Module&) = delete;
+
+public:
+    // CONSTRUCTOR - TAIL MODULE
+    // Opens "fileStr" (nothing is read until the first Poll)
+    Tail_Module(const char* fileStr) : fileName(fileStr) {
+        first = 0;
+        line = 1;
+        lastArrival = -HUGE_VALF;
+        closed = false;
+        failed = false;
+        fd = open(fileStr, O_RDONLY);
+        if (fd < 0) {
+            cerr << "Could not open input file " << fileName << "\n";
+            failed = true;
+            closed = true;
+        }
+    }
+
+    // DE-CONSTRUCTOR - TAIL MODULE
+    ~Tail_Module() {
+        if (fd >= 0)
+            close(fd);
+    }
+
+    // FAILED
+    // Returns true if the file could not be read or parsed (nothing after the last
+    // good process is read)
+    bool Failed() const {
+        return failed;
+    }
+
+    // POLL
+    // Reads the complete lines appended to the file since the last poll and returns
+    // the number of processes they held
+    size_t Poll() {
+        uint64_t before = End();
+        while (!closed) {
+            size_t carried = buffer.size();
+            buffer.resize(carried + CHUNK);
+            ssize_t n = read(fd, buffer.data() + carried, CHUNK);
+            buffer.resize(carried + (n > 0 ? (size_t)n : 0));
+            if (n < 0) {
+                cerr << "Could not read input file " << fileName << "\n";
+                Fail();
+            }
+            if (n <= 0)
+                break;
+            Parse(false);
+        }
+        return (size_t)(End() - before);
+    }
+
+    // CLOSE
+    // Reads what is left of the file (including a last line without a newline) and
+    // stops following it; the horizon becomes infinite
+    void Close() {
+        Poll();
+        if (!closed)
+            Parse(true);
+        closed = true;
+    }
+
+    // HORIZON
+    // Returns the time from which on processes not read yet may arrive
+    float Horizon() const {
+        return closed ? HUGE_VALF : lastArrival;
+    }
+
+    // END
+    // Returns the index of the process after the last one read
+    uint64_t End() const {
+        return first + processes.size();
+    }
+
+    // AT
+    // Returns the process with index "index" (NULL if it has not been read yet)
+    const Process_t* At(uint64_t index) const {
+        if (index >= End())
+            return NULL;
+        return &processes[(size_t)(index - first)];
+    }
+
+    // TRIM
+    // Forgets the processes before "index" (every run has admitted them)
+    void Trim(uint64_t index) {
+        while (first < index && !processes.empty()) {
+            processes.pop_front();
+            first++;
+        }
+    }
+
+private:
+    // FAIL
+    // Stops reading the file
+    void Fail() {
+        failed = true;
+        closed = true;
+    }
+
+    // PARSE
+    // Parses the complete lines in the buffer ("all" of it at the end of the file)
+    // and keeps the partial line that follows them
+    void Parse(bool all) {
+        const char* begin = buffer.data();
+        const char* end = begin + buffer.size();
+        if (!all) {
+            while (end > begin && end[-1] != '\n')
+                end--;
+        }
+        const char* p = begin;
+        float arrtime, servtime;
+        int result;
+        while ((result = Workload_Module::ParseProcess(p, end, line, arrtime, servtime))
+                == Workload_Module::PARSED) {
+            // checked as a loaded workload is (see Workload_Module::FirstInvalid)
+            if (!Workload_Module::ValidProcess(max(lastArrival, 0.0f), arrtime,
+                                                servtime)) {
+                cerr << fileName << ":" << line << ": the processes must arrive "
+                        "in order, at finite, non-negative times\n";
+                Fail();
+                return;
+            }
+            Process_t process = { (unsigned int)End(), arrtime, servtime };
+            processes.push_back(process);
+            lastArrival = arrtime;
+        }
+        if (result == Workload_Module::MALFORMED) {
+            cerr << fileName << ":" << line << ": expected \"arrival service\"\n";
+            Fail();
+            return;
+        }
+        buffer.erase(buffer.begin(), buffer.begin() + (end - begin));
+    }
+};
+
+// Hands out the processes of a followed file to one run
+class TailSource_Module : public Source_Module {
+private:
+    Tail_Module* tail;      // the file being followed
+    uint64_t position;      // index of the next process
+
+public:
+    // CONSTRUCTOR - TAIL SOURCE MODULE
+    TailSource_Module(Tail_Module* followed) {
+        tail = followed;
+        position = 0;
+    }
+
+    // POSITION
+    // Returns the index of the next process to be handed out
+    uint64_t Position() const {
+        return position;
+    }
+
+    // PEEK
+    // Returns the next process to arrive (NULL if it has not been read yet)
+    virtual const Process_t* Peek() {
+        return tail->At(position);
+    }
+
+    // POP
+    // Consumes the process returned by Peek()
+    virtual void Pop() {
+        position++;
+    }
+
+    // HORIZON
+    // Returns the time from which on processes not read yet may arrive
+    virtual float Horizon() {
+        return tail->Horizon();
+    }
+};
+
+#endif // RR_TAIL_MODULE_H_
@@ -0,0 +1,147 @@
+#ifndef RR_THREADPOOL_MODULE_H_
+#define RR_THREADPOOL_MODULE_H_
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+using namespace std;
+
+class ThreadPool_Module {
+public:
+    // a task receives the index of the worker running it, so per-worker state
+    // (queues, CPU, scheduler, ...) can be looked up without any locking
+    typedef function<void(int)> Task_t;
+
+private:
+    // every worker owns a deque of tasks; the owner pops from the back and idle
+    // workers steal from the front of somebody else's deque
+    struct WorkerQueue {
+        mutex lock;
+        deque<Task_t> tasks;
+    };
+
+    vector<thread> workers;         // the worker threads
+    vector<WorkerQueue*> queues;    // one task deque per worker
+    mutex stateLock;                // guards the sleeping/waiting state below
+    condition_variable workReady;   // signalled when tasks are submitted
+    condition_variable allDone;     // signalled when the last pending task finishes
+    atomic<int> pending;            // tasks submitted but not yet finished
+    unsigned int nextQueue;         // round robin index used when submitting
+    bool stopping;                  // set when the pool is being destroyed
+
+public:
+    // CONSTRUCTOR - THREAD POOL MODULE
+    ThreadPool_Module(unsigned int threads = 0) : pending(0) {
+        if (threads == 0)
+            threads = thread::hardware_concurrency();
+        if (threads == 0)
+            threads = 1;
+        nextQueue = 0;
+        stopping = false;
+        for (unsigned int i = 0; i < threads; i++)
+            queues.push_back(new WorkerQueue);
+        for (unsigned int i = 0; i < threads; i++)
+            workers.push_back(thread(&ThreadPool_Module::WorkerLoop, this, (int)i));
+    }
+
+    // DE-CONSTRUCTOR - THREAD POOL MODULE
+    ~ThreadPool_Module() {
+        {
+            lock_guard<mutex> guard(stateLock);
+            stopping = true;
+        }
+        workReady.notify_all();
+        for (size_t i = 0; i < workers.size(); i++)
+            workers[i].join();
+        for (size_t i = 0; i < queues.size(); i++)
+            delete queues[i];
+    }
+
+    // SIZE
+    // Returns the number of worker threads
+    unsigned int Size() const {
+        return (unsigned int)workers.size();
+    }
+
+    // SUBMIT
+    // Places a task on the next worker's deque (round robin) and wakes the workers
+    void Submit(const Task_t& task) {
+        WorkerQueue* q = queues[nextQueue++ % queues.size()];
+        pending++;
+        {
+            lock_guard<mutex> guard(q->lock);
+            q->tasks.push_back(task);
+        }
+        {
+            lock_guard<mutex> guard(stateLock);
+        }
+        workReady.notify_all();
+    }
+
+    // WAIT
+    // Blocks until every submitted task has finished
+    void Wait() {
+        unique_lock<mutex> guard(stateLock);
+        while (pending.load() != 0)
+            allDone.wait(guard);
+    }
+
+private:
+    // POP TASK
+    // Takes a task from the worker's own deque, or steals one from another worker
+    bool PopTask(int worker, Task_t& task) {
+        WorkerQueue* own = queues[worker];
+        {
+            lock_guard<mutex> guard(own->lock);
+            if (!own->tasks.empty()) {
+                task = own->tasks.back();
+                own->tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < queues.size(); i++) {
+            WorkerQueue* victim = queues[(worker + i) % queues.size()];
+            lock_guard<mutex> guard(victim->lock);
+            if (!victim->tasks.empty()) {
+                task = victim->tasks.front();
+                victim->tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // WORKER LOOP
+    // Runs tasks until the pool is destroyed, sleeping while there is no work
+    void WorkerLoop(int worker) {
+        Task_t task;
+        while (true) {
+            if (PopTask(worker, task)) {
+                task(worker);
+                task = Task_t();
+                if (--pending == 0) {
+                    lock_guard<mutex> guard(stateLock);
+                    allDone.notify_all();
+                }
+                continue;
+            }
+            unique_lock<mutex> guard(stateLock);
+            if (stopping)
+                return;
+            // re-check under the state lock so a submit cannot slip by unnoticed
+            bool haveWork = false;
+            for (size_t i = 0; i < queues.size() && !haveWork; i++) {
+                lock_guard<mutex> qguard(queues[i]->lock);
+                haveWork = !queues[i]->tasks.empty();
+            }
+            if (!haveWork)
+                workReady.wait(guard);
+        }
+    }
+};
+
+#endif // RR_THREADPOOL_MODULE_H_
@@ -0,0 +1,195 @@
+// Decodes a timeline written by rr-simulator --timeline (see rr-timeline-module.h),
+// either as CSV (one event per line) or as a Gantt-style chart with one row per
+// process: '#' while it runs, '.' while it waits in the ready queue. The CPU row
+// shows '#' while the CPU is busy and '-' while it idles.
+//
+//     rr-timeline-decode [--csv | --gantt] [--width=N] [--rows=N] <timeline>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+using namespace std;
+
+#include "rr-timeline-module.h"
+
+bool read_header(FILE*, Timeline_Header&, const char*);
+bool read_records(FILE*, vector<Timeline_Record>&);
+void write_csv(FILE*, const Timeline_Header&);
+void write_gantt(FILE*, const Timeline_Header&, int, int);
+
+int main(int argc, char** argv) {
+    bool gantt = false;
+    int width = 100, rows = 40;
+    const char* infile = NULL;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--csv")
+            gantt = false;
+        else if (arg == "--gantt")
+            gantt = true;
+        else if (arg.compare(0, 8, "--width=") == 0)
+            width = atoi(arg.c_str() + 8);
+        else if (arg.compare(0, 7, "--rows=") == 0)
+            rows = atoi(arg.c_str() + 7);
+        else if (infile == NULL)
+            infile = argv[i];
+    }
+    if (infile == NULL || width <= 0 || rows < 0) {
+        cerr << "Usage: " << argv[0] << " [--csv | --gantt] [--width=N] [--rows=N] "
+                "<timeline>\n";
+        return EXIT_FAILURE;
+    }
+    FILE* file = fopen(infile, "rb");
+    if (file == NULL) {
+        cerr << "Could not open " << infile << "\n";
+        return EXIT_FAILURE;
+    }
+    Timeline_Header header;
+    if (!read_header(file, header, infile)) {
+        fclose(file);
+        return EXIT_FAILURE;
+    }
+    if (gantt)
+        write_gantt(file, header, width, rows);
+    else
+        write_csv(file, header);
+    fclose(file);
+    return EXIT_SUCCESS;
+}
+
+// READ HEADER
+// Reads and checks the timeline header
+bool read_header(FILE* file, Timeline_Header& header, const char* fileStr) {
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+            memcmp(header.magic, RR_TIMELINE_MAGIC, sizeof(RR_TIMELINE_MAGIC)) != 0 ||
+            header.version != RR_TIMELINE_VERSION ||
+            header.recordSize != sizeof(Timeline_Record)) {
+        cerr << fileStr << " is not a timeline\n";
+        return false;
+    }
+    return true;
+}
+
+// READ RECORDS
+// Reads the next batch of records (false at the end of the file)
+bool read_records(FILE* file, vector<Timeline_Record>& records) {
+    records.resize(65536);
+    size_t n = fread(records.data(), sizeof(Timeline_Record), records.size(), file);
+    records.resize(n);
+    return n > 0;
+}
+
+// WRITE CSV
+// Writes every event as "time,event,pid"
+void write_csv(FILE* file, const Timeline_Header& header) {
+    static const char* names[] = { "arrival", "dispatch", "preempt", "complete", "idle" };
+    printf("# tq=%g overhead=%g records=%llu dropped=%llu\n", header.timeQuantum,
+            header.overhead, (unsigned long long)header.records,
+            (unsigned long long)header.dropped);
+    printf("time,event,pid\n");
+    vector<Timeline_Record> records;
+    while (read_records(file, records)) {
+        for (size_t i = 0; i < records.size(); i++) {
+            const Timeline_Record& record = records[i];
+            const char* name = (record.type <= Timeline_Record::TL_IDLE) ?
+                                names[record.type] : "unknown";
+            if (record.processId == Timeline_Record::NO_PROCESS)
+                printf("%.6f,%s,\n", record.time, name);
+            else
+                printf("%.6f,%s,%u\n", record.time, name, record.processId);
+        }
+    }
+}
+
+// Where a process is on the chart
+struct Gantt_Row {
+    string cells;       // the row's characters
+    float since;        // when the process entered its current state
+    bool running;       // it is on the CPU (else it waits)
+};
+
+// MARK
+// Marks the columns covering [from, to] with "mark" ('.' never covers '#')
+void mark(string& cells, float from, float to, float start, double columnWidth,
+            char mark) {
+    int width = (int)cells.size();
+    int first = (int)floor((from - start) / columnWidth);
+    int last = (int)floor((to - start) / columnWidth);
+    if (first < 0)
+        first = 0;
+    if (last >= width)
+        last = width - 1;
+    for (int c = first; c <= last; c++) {
+        if (mark == '#' || cells[c] == ' ')
+            cells[c] = mark;
+    }
+}
+
+// WRITE GANTT
+// Writes the chart of the CPU and the first "rows" processes to arrive
+void write_gantt(FILE* file, const Timeline_Header& header, int width, int rows) {
+    // pass 1: the time span
+    vector<Timeline_Record> records;
+    float start = HUGE_VALF, end = -HUGE_VALF;
+    while (read_records(file, records)) {
+        for (size_t i = 0; i < records.size(); i++) {
+            start = min(start, records[i].time);
+            end = max(end, records[i].time);
+        }
+    }
+    if (start > end) {
+        printf("(empty timeline)\n");
+        return;
+    }
+    double columnWidth = (end > start) ? (end - start) / width : 1.0;
+    // pass 2: the rows
+    fseek(file, sizeof(Timeline_Header), SEEK_SET);
+    Gantt_Row cpu = { string(width, ' '), start, false };
+    map<uint32_t, Gantt_Row> processes;
+    vector<uint32_t> order;
+    while (read_records(file, records)) {
+        for (size_t i = 0; i < records.size(); i++) {
+            const Timeline_Record& record = records[i];
+            // the cpu: busy from a dispatch, idle from an idle record
+            if (record.type == Timeline_Record::TL_DISPATCH ||
+                    record.type == Timeline_Record::TL_IDLE) {
+                mark(cpu.cells, cpu.since, record.time, start, columnWidth,
+                        cpu.running ? '#' : '-');
+                cpu.since = record.time;
+                cpu.running = (record.type == Timeline_Record::TL_DISPATCH);
+            }
+            if (record.processId == Timeline_Record::NO_PROCESS)
+                continue;
+            map<uint32_t, Gantt_Row>::iterator it = processes.find(record.processId);
+            if (it == processes.end()) {
+                if ((int)order.size() >= rows || record.type != Timeline_Record::TL_ARRIVAL)
+                    continue;
+                Gantt_Row row = { string(width, ' '), record.time, false };
+                it = processes.insert(make_pair(record.processId, row)).first;
+                order.push_back(record.processId);
+                continue;
+            }
+            Gantt_Row& row = it->second;
+            mark(row.cells, row.since, record.time, start, columnWidth,
+                    row.running ? '#' : '.');
+            row.since = record.time;
+            row.running = (record.type == Timeline_Record::TL_DISPATCH);
+            if (record.type == Timeline_Record::TL_COMPLETE)
+                row.since = HUGE_VALF;     // nothing more to draw
+        }
+    }
+    printf("tq = %g secs, overhead = %g secs, %llu records (%llu dropped)\n",
+            header.timeQuantum, header.overhead, (unsigned long long)header.records,
+            (unsigned long long)header.dropped);
+    printf("%g .. %g secs, %g secs per column\n", start, end, columnWidth);
+    printf("%-10s|%s|\n", "CPU", cpu.cells.c_str());
+    for (size_t i = 0; i < order.size(); i++) {
+        char label[32];
+        snprintf(label, sizeof(label), "PID %u", order[i]);
+        printf("%-10s|%s|\n", label, processes[order[i]].cells.c_str());
+    }
+}
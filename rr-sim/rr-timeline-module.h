@@ -0,0 +1,182 @@
+#ifndef RR_TIMELINE_MODULE_H_
+#define RR_TIMELINE_MODULE_H_
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+using namespace std;
+
+// Timeline file format (all fields in host byte order; rr-timeline-decode reads
+// the timelines of a host like the one that wrote them):
+//   header  | char magic[8] = "RRTIMELN" | uint32 version | uint32 record size |
+//           | float time quantum | float overhead | uint64 records | uint64 dropped |
+//   records | Timeline_Record[records]                                          |
+// The record and dropped counts are filled in when the timeline is closed.
+const char RR_TIMELINE_MAGIC[8] = { 'R', 'R', 'T', 'I', 'M', 'E', 'L', 'N' };
+const uint32_t RR_TIMELINE_VERSION = 1;
+
+struct Timeline_Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    float timeQuantum;
+    float overhead;
+    uint64_t records;
+    uint64_t dropped;
+};
+
+// One event of a simulation run
+struct Timeline_Record {
+    // Describes what happened
+    enum RecordType_t {
+        TL_ARRIVAL = 0,     // a process arrived (time = its arrival time)
+        TL_DISPATCH,        // a process was put on the CPU
+        TL_PREEMPT,         // a process used up its quantum and went back to the queue
+        TL_COMPLETE,        // a process finished
+        TL_IDLE             // the CPU ran out of processes (process = NO_PROCESS)
+    };
+    static const uint32_t NO_PROCESS = 0xFFFFFFFFu;
+
+    float time;             // when it happened [CPU clock]
+    uint32_t processId;     // the process it happened to
+    uint8_t type;           // what happened (RecordType_t)
+    uint8_t reserved[3];
+};
+
+// Writes the events of one run to a timeline file. The simulation thread only
+// stores records in a single producer/single consumer ring; a background thread
+// drains the ring to disk in large writes, so the simulation never waits for the
+// disk. If the writer falls a whole ring behind, records are dropped (and counted
+// in the header) rather than stalling the simulation. A timeline that cannot be
+// written records nothing more, and Close() reports it.
+class Timeline_Module {
+private:
+    static const size_t RING_SIZE = (size_t)1 << 20;    // records (a power of two)
+    static const size_t BATCH_SIZE = 8192;              // records per write
+
+    vector<Timeline_Record> ring;       // the ring shared with the writer
+    alignas(64) atomic<uint64_t> head;  // records stored (written by the simulation)
+    alignas(64) atomic<uint64_t> tail;  // records drained (written by the writer)
+    alignas(64) atomic<bool> stopping;  // set when the timeline is being closed
+    uint64_t dropped;                   // records that did not fit (simulation side)
+    uint64_t written;                   // records written whole (writer side)
+    int fd;                             // the timeline file
+    atomic<bool> failed;                // the file could not be written
+    thread writer;                      // the background writer
+    Timeline_Header header;             // the file header
+
+    // the writer thread points at this object, so it is never copied
+    Timeline_Module(const Timeline_Module&) = delete;
+    Timeline_Module& operator=(const Timeline_Module&) = delete;
+
+public:
+    // CONSTRUCTOR - TIMELINE MODULE
+    // Creates "fileStr" for a run with the given time quantum and overhead
+    Timeline_Module(const char* fileStr, float timeQuantum, float overhead)
+        : ring(RING_SIZE), head(0), tail(0), stopping(false), failed(false)
+    {
+        dropped = 0;
+        written = 0;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, RR_TIMELINE_MAGIC, sizeof(RR_TIMELINE_MAGIC));
+        header.version = RR_TIMELINE_VERSION;
+        header.recordSize = sizeof(Timeline_Record);
+        header.timeQuantum = timeQuantum;
+        header.overhead = overhead;
+        fd = open(fileStr, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0 || write(fd, &header, sizeof(header)) != (ssize_t)sizeof(header)) {
+            failed = true;
+            return;
+        }
+        writer = thread(&Timeline_Module::WriterLoop, this);
+    }
+
+    // DE-CONSTRUCTOR - TIMELINE MODULE
+    ~Timeline_Module() {
+        Close();
+    }
+
+    // CLOSE
+    // Drains the ring and completes the header; returns false if the timeline could
+    // not be written (its header then counts the records that made it to the file)
+    bool Close() {
+        if (writer.joinable()) {
+            stopping.store(true, memory_order_release);
+            writer.join();
+        }
+        if (fd >= 0) {
+            header.records = written;
+            header.dropped = dropped;
+            if (pwrite(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header))
+                failed = true;
+            close(fd);
+            fd = -1;
+            if (dropped > 0)
+                cerr << "Timeline: " << dropped << " records dropped (writer too slow)\n";
+        }
+        return !failed;
+    }
+
+    // RECORD
+    // Stores an event (never blocks)
+    void Record(Timeline_Record::RecordType_t type, float time,
+                uint32_t processId = Timeline_Record::NO_PROCESS) {
+        if (failed.load(memory_order_relaxed))
+            return;
+        uint64_t h = head.load(memory_order_relaxed);
+        if (h - tail.load(memory_order_acquire) == RING_SIZE) {
+            dropped++;
+            return;
+        }
+        Timeline_Record& record = ring[h & (RING_SIZE - 1)];
+        record.time = time;
+        record.processId = processId;
+        record.type = (uint8_t)type;
+        record.reserved[0] = record.reserved[1] = record.reserved[2] = 0;
+        head.store(h + 1, memory_order_release);
+    }
+
+private:
+    // WRITER LOOP
+    // Drains the ring to the file until the timeline is closed and drained (or the
+    // file cannot be written)
+    void WriterLoop() {
+        while (true) {
+            bool stop = stopping.load(memory_order_acquire);
+            uint64_t t = tail.load(memory_order_relaxed);
+            uint64_t h = head.load(memory_order_acquire);
+            if (h == t) {
+                if (stop)
+                    return;
+                this_thread::sleep_for(chrono::microseconds(200));
+                continue;
+            }
+            // write a contiguous stretch of the ring (up to its end)
+            size_t start = (size_t)(t & (RING_SIZE - 1));
+            size_t count = (size_t)min<uint64_t>(h - t, BATCH_SIZE);
+            count = min(count, RING_SIZE - start);
+            const char* bytes = (const char*)&ring[start];
+            size_t length = count * sizeof(Timeline_Record);
+            size_t done = 0;
+            while (done < length) {
+                ssize_t n = write(fd, bytes + done, length - done);
+                if (n <= 0) {
+                    written += done / sizeof(Timeline_Record);
+                    failed = true;
+                    return;
+                }
+                done += (size_t)n;
+            }
+            written += count;
+            tail.store(t + count, memory_order_release);
+        }
+    }
+};
+
+#endif // RR_TIMELINE_MODULE_H_
@@ -0,0 +1,43 @@
+// Converts a process list between the tab separated text format and the binary
+// trace format (see rr-workload-module.h). The input format is detected
+// automatically; the output format is binary unless --text is given.
+//
+//     rr-trace-convert [--text] <input> <output>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+using namespace std;
+
+#include "rr-workload-module.h"
+
+int main(int argc, char** argv) {
+    bool toText = false;
+    const char* infile = NULL;
+    const char* outfile = NULL;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--text")
+            toText = true;
+        else if (infile == NULL)
+            infile = argv[i];
+        else if (outfile == NULL)
+            outfile = argv[i];
+    }
+    if (infile == NULL || outfile == NULL) {
+        cerr << "Usage: " << argv[0] << " [--text] <input> <output>\n";
+        return EXIT_FAILURE;
+    }
+    Workload_Module workload;
+    if (!workload.Load(infile)) {
+        cerr << "Could not read " << infile << ": " << workload.Error() << "\n";
+        return EXIT_FAILURE;
+    }
+    bool ok = toText ? workload.SaveText(outfile) : workload.SaveBinary(outfile);
+    if (!ok) {
+        cerr << "Could not write " << outfile << "\n";
+        return EXIT_FAILURE;
+    }
+    cout << workload.Size() << " processes written to " << outfile << "\n";
+    return EXIT_SUCCESS;
+}
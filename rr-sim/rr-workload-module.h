@@ -0,0 +1,382 @@
+#ifndef RR_WORKLOAD_MODULE_H_
+#define RR_WORKLOAD_MODULE_H_
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+using namespace std;
+
+
+// Binary trace format (all fields in the byte order of the host that wrote it):
+//   header  | char magic[8] = "RRTRACE" | uint32 version | uint32 reserved |
+//           | uint64 count                                                 |
+//   columns | float32 arrival[count] | float32 service[count]             |
+// The columns are fixed width so a mapped file can be used without decoding, which
+// is why they are not byte swapped; a trace from a host of the other byte order is
+// rejected (its version does not match).
+const char RR_TRACE_MAGIC[8] = { 'R', 'R', 'T', 'R', 'A', 'C', 'E', '\0' };
+const uint32_t RR_TRACE_VERSION = 1;
+
+struct Trace_Header {
+    char magic[8];          // RR_TRACE_MAGIC
+    uint32_t version;       // RR_TRACE_VERSION
+    uint32_t reserved;      // always zero
+    uint64_t count;         // number of processes in the trace
+};
+
+// Holds the parsed process list (arrival and service time columns). It is filled
+// once and then only read, so every simulation of a sweep can share it.
+class Workload_Module {
+private:
+    vector<float> arrivalTimes;     // arrival times parsed from text / added by hand
+    vector<float> serviceTimes;     // service times parsed from text / added by hand
+    const float* arrivalCol;        // the arrival time column in use
+    const float* serviceCol;        // the service time column in use
+    unsigned int count;             // number of processes in the columns
+    void* mapping;                  // mapped binary trace backing the columns (if any)
+    size_t mappingSize;             // size of the mapping in bytes
+    string error;                   // what went wrong with the last Load (if anything)
+
+    // the mapping is owned, so a workload is never copied
+    Workload_Module(const Workload_Module&) = delete;
+    Workload_Module& operator=(const Workload_Module&) = delete;
+
+public:
+    // CONSTRUCTOR - WORKLOAD MODULE
+    Workload_Module() {
+        arrivalCol = NULL;
+        serviceCol = NULL;
+        count = 0;
+        mapping = NULL;
+        mappingSize = 0;
+    }
+
+    // DE-CONSTRUCTOR - WORKLOAD MODULE
+    ~Workload_Module() {
+        Clear();
+    }
+
+    // ADD PROCESS
+    // Appends a process to the end of the workload
+    void AddProcess(float arrTime, float servTime) {
+        if (mapping != NULL)
+            CopyOutOfMapping();
+        arrivalTimes.push_back(arrTime);
+        serviceTimes.push_back(servTime);
+        arrivalCol = arrivalTimes.data();
+        serviceCol = serviceTimes.data();
+        count++;
+    }
+
+    // RESERVE
+    // Reserves room for "processes" processes
+    void Reserve(size_t processes) {
+        arrivalTimes.reserve(processes);
+        serviceTimes.reserve(processes);
+        arrivalCol = arrivalTimes.data();
+        serviceCol = serviceTimes.data();
+    }
+
+    // CLEAR
+    // Removes every process from the workload (and unmaps a mapped trace)
+    void Clear() {
+        if (mapping != NULL)
+            munmap(mapping, mappingSize);
+        mapping = NULL;
+        mappingSize = 0;
+        arrivalTimes.clear();
+        serviceTimes.clear();
+        arrivalCol = NULL;
+        serviceCol = NULL;
+        count = 0;
+    }
+
+    // SIZE
+    // Returns the number of processes in the workload
+    unsigned int Size() const {
+        return count;
+    }
+
+    // GET ARRIVAL TIME
+    // Returns the arrival time of process "id"
+    float GetArrivalTime(unsigned int id) const {
+        return arrivalCol[id];
+    }
+
+    // GET SERVICE TIME
+    // Returns the service time of process "id"
+    float GetServiceTime(unsigned int id) const {
+        return serviceCol[id];
+    }
+
+    // HASH
+    // Returns a 64-bit hash of the processes (text and binary traces of the same
+    // processes hash the same)
+    uint64_t Hash() const {
+        uint64_t h = Mix(count);
+        for (unsigned int i = 0; i < count; i++) {
+            uint32_t a, s;
+            memcpy(&a, &arrivalCol[i], sizeof(a));
+            memcpy(&s, &serviceCol[i], sizeof(s));
+            h = Mix(h ^ ((uint64_t)a | ((uint64_t)s << 32)));
+        }
+        return h;
+    }
+
+    // FIRST INVALID
+    // Returns the first process that cannot be simulated (a negative or non-finite
+    // time, or an arrival before the previous process's), or Size() if there is none
+    unsigned int FirstInvalid() const {
+        float previous = 0.0f;
+        for (unsigned int i = 0; i < count; i++) {
+            if (!ValidProcess(previous, arrivalCol[i], serviceCol[i]))
+                return i;
+            previous = arrivalCol[i];
+        }
+        return count;
+    }
+
+    // VALID PROCESS
+    // Returns true if a process can be simulated after one that arrived at
+    // "previous" (0 for the first): finite, non-negative times, in arrival order
+    static bool ValidProcess(float previous, float arrival, float service) {
+        return (arrival >= previous && isfinite(arrival) &&
+                service >= 0.0f && isfinite(service));
+    }
+
+    // ERROR
+    // Returns what went wrong with the last Load (empty if it succeeded)
+    const string& Error() const {
+        return error;
+    }
+
+    // LOAD
+    // Loads a process list in either the binary trace format or the text format
+    // (one "arrival<whitespace>service" pair per line). Returns false on error (see
+    // Error).
+    bool Load(const char* fileStr) {
+        Clear();
+        error.clear();
+        int fd = open(fileStr, O_RDONLY);
+        if (fd < 0) {
+            error = "the file could not be opened";
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            error = "the file could not be examined";
+            return false;
+        }
+        size_t size = (size_t)st.st_size;
+        if (size == 0) {
+            close(fd);
+            return true;
+        }
+        void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED) {
+            error = "the file could not be mapped";
+            return false;
+        }
+        if (size >= sizeof(Trace_Header) &&
+                memcmp(data, RR_TRACE_MAGIC, sizeof(RR_TRACE_MAGIC)) == 0) {
+            // the binary columns are used in place; the mapping lives as long as
+            // the workload does
+            return AdoptBinary(data, size);
+        }
+        madvise(data, size, MADV_SEQUENTIAL);
+        bool ok = ParseText((const char*)data, (const char*)data + size);
+        munmap(data, size);
+        return ok;
+    }
+
+    // SAVE BINARY
+    // Writes the workload to "fileStr" in the binary trace format
+    bool SaveBinary(const char* fileStr) const {
+        FILE* out = fopen(fileStr, "wb");
+        if (out == NULL)
+            return false;
+        Trace_Header header;
+        memcpy(header.magic, RR_TRACE_MAGIC, sizeof(RR_TRACE_MAGIC));
+        header.version = RR_TRACE_VERSION;
+        header.reserved = 0;
+        header.count = count;
+        bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+        if (count > 0) {
+            ok = ok && fwrite(arrivalCol, sizeof(float), count, out) == count;
+            ok = ok && fwrite(serviceCol, sizeof(float), count, out) == count;
+        }
+        ok = (fclose(out) == 0) && ok;
+        return ok;
+    }
+
+    // SAVE TEXT
+    // Writes the workload to "fileStr" in the tab separated text format
+    bool SaveText(const char* fileStr) const {
+        FILE* out = fopen(fileStr, "w");
+        if (out == NULL)
+            return false;
+        for (unsigned int id = 0; id < count; id++)
+            fprintf(out, "%s%.9g\t%.9g", (id == 0) ? "" : "\n",
+                    arrivalCol[id], serviceCol[id]);
+        return fclose(out) == 0;
+    }
+
+    // results of ParseProcess()
+    enum ParseResult_t {
+        PARSED = 0,     // a process was parsed
+        NO_MORE,        // only blank space was left
+        MALFORMED       // the line is not an "arrival service" pair
+    };
+
+    // PARSE PROCESS
+    // Parses the next "arrival service" pair starting at "p" (advancing it past the
+    // line) and counts the lines passed in "line"; blank lines are skipped.
+    static int ParseProcess(const char*& p, const char* end, unsigned int& line,
+                            float& arrtime, float& servtime) {
+        // skip blank space (and count lines) up to the next number
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+            if (*p == '\n')
+                line++;
+            p++;
+        }
+        if (p >= end)
+            return NO_MORE;
+        if (!ParseFloat(p, end, arrtime))
+            return MALFORMED;
+        while (p < end && (*p == ' ' || *p == '\t'))
+            p++;
+        if (!ParseFloat(p, end, servtime))
+            return MALFORMED;
+        // ignore anything else on the line
+        while (p < end && *p != '\n')
+            p++;
+        return PARSED;
+    }
+
+    // PARSE FLOAT
+    // Parses a decimal number starting at "p" (advancing it) without needing a
+    // terminating NUL. Short numbers are converted with a single correctly rounded
+    // division, which gives the same result as atof(); anything else is handed to
+    // strtod() through a small buffer.
+    static bool ParseFloat(const char*& p, const char* end, float& value) {
+        static const double POW10[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        const char* start = p;
+        const char* q = p;
+        bool negative = false;
+        if (q < end && (*q == '-' || *q == '+'))
+            negative = (*q++ == '-');
+        uint64_t mantissa = 0;
+        int digits = 0, fraction = 0;
+        for (; q < end && *q >= '0' && *q <= '9'; q++, digits++)
+            mantissa = mantissa * 10 + (uint64_t)(*q - '0');
+        if (q < end && *q == '.') {
+            for (q++; q < end && *q >= '0' && *q <= '9'; q++, digits++, fraction++)
+                mantissa = mantissa * 10 + (uint64_t)(*q - '0');
+        }
+        if (digits == 0)
+            return false;
+        bool simple = (q >= end || (*q != 'e' && *q != 'E')) && digits <= 15;
+        if (simple) {
+            double d = (double)mantissa / POW10[fraction];
+            value = (float)(negative ? -d : d);
+            p = q;
+            return true;
+        }
+        // slow path: long mantissas or exponents
+        char buffer[64];
+        size_t len = 0;
+        for (q = start; q < end && len < sizeof(buffer) - 1 && *q != ' ' &&
+                *q != '\t' && *q != '\r' && *q != '\n'; q++)
+            buffer[len++] = *q;
+        buffer[len] = '\0';
+        char* stop = NULL;
+        double d = strtod(buffer, &stop);
+        if (stop == buffer)
+            return false;
+        value = (float)d;
+        p = start + (stop - buffer);
+        return true;
+    }
+private:
+    // MIX
+    // Scrambles a 64-bit value (the splitmix64 finalizer)
+    static uint64_t Mix(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    // ADOPT BINARY
+    // Uses the columns of a mapped binary trace directly
+    bool AdoptBinary(void* data, size_t size) {
+        const Trace_Header* header = (const Trace_Header*)data;
+        uint64_t n = header->count;
+        if (header->version != RR_TRACE_VERSION || n > 0xFFFFFFFFull ||
+                size < sizeof(Trace_Header) + n * 2 * sizeof(float)) {
+            error = "malformed binary trace";
+            munmap(data, size);
+            return false;
+        }
+        mapping = data;
+        mappingSize = size;
+        arrivalCol = (const float*)((const char*)data + sizeof(Trace_Header));
+        serviceCol = arrivalCol + n;
+        count = (unsigned int)n;
+        return true;
+    }
+
+    // COPY OUT OF MAPPING
+    // Copies mapped columns into owned storage so the workload can be modified
+    void CopyOutOfMapping() {
+        arrivalTimes.assign(arrivalCol, arrivalCol + count);
+        serviceTimes.assign(serviceCol, serviceCol + count);
+        munmap(mapping, mappingSize);
+        mapping = NULL;
+        mappingSize = 0;
+        arrivalCol = arrivalTimes.data();
+        serviceCol = serviceTimes.data();
+    }
+
+    // PARSE TEXT
+    // Parses "arrival service" pairs from [begin, end); blank lines are skipped
+    bool ParseText(const char* begin, const char* end) {
+        // a process takes a line, so the lines bound the reservation (one pass of
+        // memchr, instead of reserving for the shortest lines and shrinking after)
+        size_t lines = 1;
+        for (const char* q = begin; (q = (const char*)memchr(q, '\n', end - q)) != NULL; q++)
+            lines++;
+        Reserve(lines);
+        const char* p = begin;
+        unsigned int line = 1;
+        float arrtime, servtime;
+        int result;
+        while ((result = ParseProcess(p, end, line, arrtime, servtime)) == PARSED) {
+            arrivalTimes.push_back(arrtime);
+            serviceTimes.push_back(servtime);
+        }
+        if (result == MALFORMED) {
+            error = "line " + to_string(line) + ": expected \"arrival service\"";
+            return false;
+        }
+        arrivalCol = arrivalTimes.data();
+        serviceCol = serviceTimes.data();
+        count = (unsigned int)arrivalTimes.size();
+        return true;
+    }
+};
+
+#endif // RR_WORKLOAD_MODULE_H_
@@ -0,0 +1,171 @@
+#!/bin/bash
+# Runs the sweep in one mode of rr-simulator and checks that its analysis and excel
+# output match the reference simulator's on the same process list.
+#
+#     run-mode.sh BIN_DIR MODE INPUT
+#
+# MODE is one of step, engine, split, cpus, processes, follow, checkpoint, cache,
+# binary, stream, generate, timeline, results, optimize, golden (the reference
+# itself against tests/expected) or bad-input (every way of reading a bad process
+# list must fail). INPUT is "process-list" (input/process-list.txt) or "generated"
+# (a synthetic trace written by this script, with Poisson arrivals at about 90%
+# utilization).
+
+set -u
+BIN=$1
+MODE=$2
+INPUT=$3
+SOURCE=$(cd "$(dirname "$0")/.." && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 1
+
+case $INPUT in
+    process-list)
+        LIST=$SOURCE/input/process-list.txt ;;
+    generated)
+        LIST=$WORK/generated.txt
+        awk 'BEGIN { srand(7); t = 0;
+                     for (i = 0; i < 100000; i++) {
+                         t += -log(1 - rand()) * 0.1;
+                         printf "%.4f\t%.4f\n", t, -log(1 - rand()) * 0.09 } }' > "$LIST" ;;
+    *)
+        echo "unknown input $INPUT"; exit 2 ;;
+esac
+
+# SWEEP
+# Runs rr-simulator with the given options into NAME-analysis.txt/NAME-excel.txt
+sweep() {
+    local name=$1
+    shift
+    "$BIN/rr-simulator" --analysis="$name-analysis.txt" --excel="$name-excel.txt" "$@"
+}
+
+# FAILS
+# Runs rr-simulator (into fail-analysis.txt/fail-excel.txt) and checks that it fails
+fails() {
+    if "$BIN/rr-simulator" --analysis=fail-analysis.txt --excel=fail-excel.txt "$@" \
+            2> /dev/null; then
+        echo "bad-input: rr-simulator $* did not fail"
+        return 1
+    fi
+}
+
+# SAME
+# Compares the output of two sweeps (profile blocks differ between modes)
+same() {
+    local ok=0
+    for kind in analysis excel; do
+        sed '/^Profile:/,/^END SIMULATION/{/^END SIMULATION/!d}' "$1-$kind.txt" > a.txt
+        sed '/^Profile:/,/^END SIMULATION/{/^END SIMULATION/!d}' "$2-$kind.txt" > b.txt
+        if ! diff -q a.txt b.txt > /dev/null; then
+            echo "$MODE: $kind output differs from the reference on $INPUT"
+            diff a.txt b.txt | head -20
+            ok=1
+        fi
+    done
+    return $ok
+}
+
+sweep reference "$LIST" || exit 1
+case $MODE in
+    step|engine|split)
+        sweep mode --$MODE "$LIST" || exit 1 ;;
+    cpus)
+        sweep mode --cpus=1 "$LIST" || exit 1 ;;
+    processes)
+        sweep mode --processes=3 "$LIST" || exit 1 ;;
+    follow)
+        # a list that stops growing is followed to its end
+        sweep mode --follow --follow-interval=0.05 --follow-idle=0.2 "$LIST" || exit 1 ;;
+    checkpoint)
+        # a sweep killed while it saves snapshots all the time resumes where it was
+        # (wherever the kill lands); a second resume finds every simulation done
+        mkdir snapshots
+        timeout -s KILL 0.3 "$BIN/rr-simulator" --analysis=killed-analysis.txt \
+            --excel=killed-excel.txt --checkpoint=snapshots --checkpoint-interval=0 \
+            "$LIST" 2> /dev/null
+        sweep mode --checkpoint=snapshots "$LIST" 2> /dev/null || exit 1
+        same reference mode || exit 1
+        sweep mode --checkpoint=snapshots "$LIST" 2> resumed.txt || exit 1
+        if [ "$(grep -c resumed resumed.txt)" != 24 ]; then
+            echo "checkpoint: not every simulation resumed from its snapshot"
+            exit 1
+        fi ;;
+    cache)
+        # the second sweep takes every simulation from the cache
+        sweep filled --cache=sweep.cache "$LIST" 2> /dev/null || exit 1
+        same reference filled || exit 1
+        sweep mode --cache=sweep.cache "$LIST" 2> hits.txt || exit 1
+        if ! grep -q "^24 of 24 simulations were found" hits.txt; then
+            echo "cache: the second sweep did not find every simulation"
+            exit 1
+        fi ;;
+    binary)
+        "$BIN/rr-trace-convert" "$LIST" trace.rrtrace > /dev/null || exit 1
+        sweep mode trace.rrtrace || exit 1 ;;
+    stream)
+        sweep streamed --stream --engine "$LIST" || exit 1
+        same reference streamed || exit 1
+        sweep mode --stream "$LIST" || exit 1 ;;
+    generate)
+        # a synthetic workload as long as the process list, loaded and streamed
+        spec=jobs=$(wc -l < "$LIST"),arrivals=onoff,service=pareto,util=0.9
+        sweep reference --generate=$spec || exit 1
+        sweep streamed --generate=$spec --stream --engine || exit 1
+        same reference streamed || exit 1
+        sweep mode --generate=$spec --engine || exit 1 ;;
+    timeline)
+        # every simulation's timeline holds an arrival per process
+        mkdir timelines
+        sweep mode --timeline=timelines "$LIST" || exit 1
+        for n in $(seq 1 24); do
+            arrivals=$("$BIN/rr-timeline-decode" --csv timelines/timeline-$n.rrtl |
+                        grep -c ",arrival,")
+            if [ "$arrivals" != "$(grep -c . "$LIST")" ]; then
+                echo "timeline: simulation #$n has $arrivals arrivals"
+                exit 1
+            fi
+        done ;;
+    results)
+        # a row per simulation, numbered in grid order, in every format
+        sweep mode --results=results.csv "$LIST" || exit 1
+        sweep jsonl --results=results.jsonl "$LIST" || exit 1
+        sweep bin --results=results.bin "$LIST" || exit 1
+        if [ "$(tail -n +2 results.csv | cut -d, -f1 | tr '\n' ' ')" != \
+                "$(seq 1 24 | tr '\n' ' ')" ] ||
+           [ "$(grep -c '^{"simulation":' results.jsonl)" != 24 ] ||
+           [ "$(stat -c %s results.bin)" != $((24 + 22 * 24 + 24 * 22 * 8)) ]; then
+            echo "results: the results files do not hold the 24 simulations"
+            exit 1
+        fi ;;
+    optimize)
+        # the search does not depend on the threads it runs on
+        sweep reference --optimize=avg-wait --threads=1 "$LIST" 2> /dev/null || exit 1
+        if [ "$(grep -c "^START OPTIMIZATION" reference-analysis.txt)" != 6 ]; then
+            echo "optimize: not every overhead was optimized"
+            exit 1
+        fi
+        sweep mode --optimize=avg-wait --threads=3 "$LIST" 2> /dev/null || exit 1 ;;
+    bad-input)
+        # out of order, negative times, malformed, missing
+        printf '5 1\n1 2\n-3 1\n' > unordered.txt
+        printf -- '-3 1\n1 -2\n2 1\n' > negative.txt
+        printf '0 1\n1 x\n' > malformed.txt
+        for list in unordered.txt negative.txt malformed.txt missing.txt; do
+            fails "$list" || exit 1
+            fails --stream "$list" || exit 1
+            fails --stream --engine "$list" || exit 1
+            fails --follow --follow-interval=0.05 --follow-idle=0.2 "$list" || exit 1
+        done
+        "$BIN/rr-trace-convert" unordered.txt unordered.rrtrace > /dev/null || exit 1
+        fails --stream unordered.rrtrace || exit 1
+        fails --timeline=missing "$LIST" || exit 1
+        exit 0 ;;
+    golden)
+        cp "$SOURCE/tests/expected/$INPUT-analysis.txt" mode-analysis.txt || exit 1
+        cp "$SOURCE/tests/expected/$INPUT-excel.txt" mode-excel.txt || exit 1 ;;
+    *)
+        echo "unknown mode $MODE"; exit 2 ;;
+esac
+same reference mode